@@ -1,4 +1,5 @@
 #!/bin/sh
 if meson compile -C build ; then
+    ./build/platformer-bake res/level.json res/level.bin &&
     ./build/platformer
 fi
@@ -0,0 +1,125 @@
+#include "ActivityRegions.hpp"
+#include <algorithm>
+#include <limits>
+
+void ActivityRegions::setCamera(float x, float y) {
+    camera = {x, y};
+    hasCamera = true;
+}
+
+void ActivityRegions::update(entt::registry &registry, double time) {
+    ++step;
+    if (time < nextUpdate) {
+        return;
+    }
+    nextUpdate = time + UPDATE_INTERVAL;
+
+    // Positions come from the simulation state rather than the interpolated
+    // PhysicsComponent, which only the windowed game keeps up to date.
+    centres.clear();
+    if (hasCamera) {
+        centres.push_back(camera);
+    }
+    registry.view<const CharacterComponent, const PlayerComponent>().each(
+        [this](const CharacterComponent &c, const PlayerComponent &) {
+            centres.push_back({c.x, c.y - c.height / 2});
+        });
+
+    const float wakeDistance = radius * radius;
+    const float sleepDistance = (radius + margin) * (radius + margin);
+    registry.view<const PhysicsComponent>(entt::exclude<PlayerComponent>)
+        .each([&](entt::entity entity, const PhysicsComponent &physC) {
+            float x = physC.x;
+            float y = physC.y;
+            if (physC.body != nullptr) {
+                x = fromBox2D(physC.body->GetPosition().x);
+                y = fromBox2D(physC.body->GetPosition().y);
+            } else if (const CharacterComponent *c =
+                           registry.try_get<CharacterComponent>(entity)) {
+                x = c->x;
+                y = c->y - c->height / 2;
+            }
+            float nearest = std::numeric_limits<float>::infinity();
+            for (const Centre &centre : centres) {
+                const float dx = x - centre.x;
+                const float dy = y - centre.y;
+                nearest = std::min(nearest, dx * dx + dy * dy);
+            }
+
+            bool dormant = registry.all_of<DormantComponent>(entity);
+            const KeepAwakeComponent *keep =
+                registry.try_get<KeepAwakeComponent>(entity);
+            if (keep != nullptr && keep->until <= time) {
+                registry.remove<KeepAwakeComponent>(entity);
+                keep = nullptr;
+            }
+            if (keep == nullptr && dormant && nearest <= wakeDistance) {
+                setDormant(registry, entity, physC, false);
+                dormant = false;
+            } else if (keep == nullptr && !dormant &&
+                       nearest > sleepDistance) {
+                setDormant(registry, entity, physC, true);
+                dormant = true;
+            }
+            if (!dormant) {
+                setTickRate(registry, entity, nearest);
+            }
+        });
+}
+
+uint32_t ActivityRegions::dueSteps(entt::entity entity,
+                                   TickRateComponent &rate) const {
+    // Intervals are powers of two, so the low bits of the id pick the step.
+    const uint32_t mask = rate.interval - 1;
+    const uint32_t phase = static_cast<uint32_t>(entt::to_integral(entity));
+    if (((step + phase) & mask) != 0) {
+        return 0;
+    }
+    const uint32_t steps = step - rate.lastStep;
+    rate.lastStep = step;
+    return steps;
+}
+
+void ActivityRegions::setTickRate(entt::registry &registry,
+                                  entt::entity entity,
+                                  float distanceSquared) const {
+    const uint32_t interval =
+        distanceSquared <= fullRateRadius * fullRateRadius   ? 1
+        : distanceSquared <= halfRateRadius * halfRateRadius ? 2
+                                                             : 4;
+    if (TickRateComponent *rate = registry.try_get<TickRateComponent>(entity)) {
+        rate->interval = interval;
+    } else {
+        // It ran on every step until now.
+        registry.emplace<TickRateComponent>(entity, interval, step - 1);
+    }
+}
+
+void ActivityRegions::wake(entt::registry &registry, entt::entity entity,
+                           double until) {
+    registry.emplace_or_replace<KeepAwakeComponent>(entity, until);
+    if (registry.all_of<DormantComponent>(entity)) {
+        setDormant(registry, entity, registry.get<PhysicsComponent>(entity),
+                   false);
+    }
+}
+
+void ActivityRegions::setDormant(entt::registry &registry,
+                                 entt::entity entity,
+                                 const PhysicsComponent &physC,
+                                 bool dormant) {
+    if (dormant) {
+        registry.emplace<DormantComponent>(entity);
+        // Picked up afresh on waking, so the first step is not a long one
+        registry.remove<TickRateComponent>(entity);
+    } else {
+        registry.remove<DormantComponent>(entity);
+    }
+    if (physC.body != nullptr) {
+        // Disabling a body ends its contacts, so foot sensors stay in step.
+        physC.body->SetEnabled(!dormant);
+        if (!dormant) {
+            physC.body->SetAwake(true);
+        }
+    }
+}
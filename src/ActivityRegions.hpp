@@ -0,0 +1,66 @@
+#pragma once
+#include <entt/entt.hpp>
+#include "components.hpp"
+#include <vector>
+
+// Keeps the simulation to the neighbourhood of the players and the camera.
+// Entities further than radius from all of them go dormant: they get a
+// DormantComponent, which the systems in MapLevel skip, and their Box2D body
+// is disabled, which takes it out of the broad phase and the solver. They
+// wake once a player or the camera comes back within radius. Going dormant
+// takes margin more pixels, so entities on the edge do not flip back and
+// forth.
+//
+// Awake entities beyond fullRateRadius run every second step, and beyond
+// halfRateRadius every fourth, with a time step that covers the steps they
+// skipped; see dueSteps(). Box2D steps its world as a whole, so this only
+// slows down systems that honour TickRateComponent.
+class ActivityRegions {
+
+  public:
+    // Seconds between two passes over the entities. A player at full speed
+    // covers less than margin in that time.
+    static constexpr double UPDATE_INTERVAL = 0.25;
+
+    float fullRateRadius = 192.0f; // Pixels; covers the default view
+    float halfRateRadius = 320.0f;
+    float radius = 480.0f;
+    float margin = 64.0f;
+
+    // The camera counts like a player once set.
+    void setCamera(float x, float y);
+
+    // Call once at the start of every simulation step. Wakes entities
+    // within radius, puts the others to sleep and sets the tick rates, at
+    // most once per UPDATE_INTERVAL of simulation time. Players never sleep
+    // and always run at full rate. Must not run during a Box2D step, while
+    // the world is locked.
+    void update(entt::registry &registry, double time);
+
+    // The number of steps since the entity with rate last ran if it runs on
+    // the current step, else 0. Entities of a tier are spread over the steps
+    // of its cycle, so the work stays even from step to step.
+    uint32_t dueSteps(entt::entity entity, TickRateComponent &rate) const;
+
+    // Wakes entity now, wherever it is, and keeps it awake until the given
+    // simulation time. Not from inside Box2D callbacks either.
+    static void wake(entt::registry &registry, entt::entity entity,
+                     double until);
+
+  private:
+    struct Centre {
+        float x;
+        float y;
+    };
+
+    static void setDormant(entt::registry &registry, entt::entity entity,
+                           const PhysicsComponent &physC, bool dormant);
+    void setTickRate(entt::registry &registry, entt::entity entity,
+                     float distanceSquared) const;
+
+    std::vector<Centre> centres;
+    uint32_t step = 0; // Counts update() calls
+    Centre camera{0.0f, 0.0f};
+    bool hasCamera = false;
+    double nextUpdate = 0.0;
+};
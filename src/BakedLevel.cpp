@@ -0,0 +1,190 @@
+#include "BakedLevel.hpp"
+#include <algorithm>
+#include <utility>
+
+BakedLevel::BakedLevel(BakedLevel &&other) noexcept {
+    *this = std::move(other);
+}
+
+BakedLevel &BakedLevel::operator=(BakedLevel &&other) noexcept {
+    if (this != &other) {
+        close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        header = std::exchange(other.header, nullptr);
+        file = std::move(other.file);
+        owned = std::move(other.owned);
+    }
+    return *this;
+}
+
+BakedLevel::~BakedLevel() { close(); }
+
+bool BakedLevel::open(const std::filesystem::path &path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+    data = file.bytes().data();
+    size = file.bytes().size();
+    return validate();
+}
+
+bool BakedLevel::adopt(std::vector<std::byte> bytes) {
+    close();
+    owned = std::move(bytes);
+    data = owned.data();
+    size = owned.size();
+    return validate();
+}
+
+bool BakedLevel::validate() {
+    if (size < sizeof(baked::Header)) {
+        close();
+        return false;
+    }
+    const auto *candidate = reinterpret_cast<const baked::Header *>(data);
+    if (candidate->magic != baked::MAGIC ||
+        candidate->version != baked::VERSION) {
+        close();
+        return false;
+    }
+
+    // Sections are read in place, so they must be aligned as well.
+    auto fits = [this](baked::Section s, size_t elementSize) {
+        return s.offset % 8 == 0 && s.offset <= size &&
+               s.count <= (size - s.offset) / elementSize;
+    };
+    if (!fits(candidate->tilesets, sizeof(baked::Tileset)) ||
+        !fits(candidate->tiles, sizeof(baked::Tile)) ||
+        !fits(candidate->tileShapes, sizeof(baked::Rect)) ||
+        !fits(candidate->grid, sizeof(uint32_t)) ||
+        !fits(candidate->colliders, sizeof(baked::Rect)) ||
+        !fits(candidate->colliderPoints, sizeof(baked::Point)) ||
+        !fits(candidate->colliderLoops, sizeof(baked::Loop)) ||
+        !fits(candidate->objects, sizeof(baked::Object)) ||
+        !fits(candidate->strings, 1) ||
+        candidate->width < 0 || candidate->height < 0 ||
+        candidate->tileWidth <= 0 || candidate->tileHeight <= 0 ||
+        candidate->grid.count != static_cast<uint64_t>(candidate->width) *
+                                     static_cast<uint64_t>(candidate->height) ||
+        !validateReferences(*candidate)) {
+        close();
+        return false;
+    }
+
+    header = candidate;
+    return true;
+}
+
+// Every index from one section into another, so readers can use them without
+// checks. Assumes the sections themselves fit.
+bool BakedLevel::validateReferences(const baked::Header &candidate) const {
+    const uint64_t stringCount = candidate.strings.count;
+    auto validString = [stringCount](baked::StringRef ref) {
+        return ref.offset <= stringCount &&
+               ref.length <= stringCount - ref.offset;
+    };
+    auto validRange = [](uint32_t first, uint32_t count, uint64_t size) {
+        return static_cast<uint64_t>(first) + count <= size;
+    };
+
+    for (const baked::Tileset &tileset :
+         section<baked::Tileset>(candidate.tilesets)) {
+        if (!validString(tileset.image)) {
+            return false;
+        }
+    }
+    // Entry 0 stands for the empty cell and is never read.
+    std::span<const baked::Tile> tileTable =
+        section<baked::Tile>(candidate.tiles);
+    for (size_t gid = 1; gid < tileTable.size(); ++gid) {
+        const baked::Tile &tile = tileTable[gid];
+        if (tile.tileset >= candidate.tilesets.count ||
+            !validRange(tile.firstShape, tile.shapeCount,
+                        candidate.tileShapes.count)) {
+            return false;
+        }
+    }
+    for (const baked::Loop &loop :
+         section<baked::Loop>(candidate.colliderLoops)) {
+        if (!validRange(loop.firstPoint, loop.pointCount,
+                        candidate.colliderPoints.count)) {
+            return false;
+        }
+    }
+    for (const baked::Object &object :
+         section<baked::Object>(candidate.objects)) {
+        if (!validString(object.name) || !validString(object.type)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BakedLevel::close() {
+    file.close();
+    owned.clear();
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+}
+
+std::span<const baked::Tileset> BakedLevel::tilesets() const {
+    return section<baked::Tileset>(header->tilesets);
+}
+
+std::span<const baked::Tile> BakedLevel::tiles() const {
+    return section<baked::Tile>(header->tiles);
+}
+
+std::span<const baked::Rect> BakedLevel::tileShapes() const {
+    return section<baked::Rect>(header->tileShapes);
+}
+
+std::span<const uint32_t> BakedLevel::grid() const {
+    return section<uint32_t>(header->grid);
+}
+
+std::span<const baked::Rect> BakedLevel::colliders() const {
+    return section<baked::Rect>(header->colliders);
+}
+
+std::span<const baked::Point> BakedLevel::colliderPoints() const {
+    return section<baked::Point>(header->colliderPoints);
+}
+
+std::span<const baked::Loop> BakedLevel::colliderLoops() const {
+    return section<baked::Loop>(header->colliderLoops);
+}
+
+std::span<const baked::Object> BakedLevel::objects() const {
+    return section<baked::Object>(header->objects);
+}
+
+std::string_view BakedLevel::string(baked::StringRef ref) const {
+    std::span<const char> strings = section<char>(header->strings);
+    if (ref.offset > strings.size() ||
+        ref.length > strings.size() - ref.offset) {
+        return {};
+    }
+    return {strings.data() + ref.offset, ref.length};
+}
+
+const baked::Tile *BakedLevel::tile(uint32_t cell) const {
+    uint32_t gid = baked::gidOf(cell);
+    std::span<const baked::Tile> table = tiles();
+    if (gid == 0 || gid >= table.size()) {
+        return nullptr;
+    }
+    return &table[gid];
+}
+
+const baked::Object *BakedLevel::firstObject(std::string_view name) const {
+    std::span<const baked::Object> all = objects();
+    auto result = std::find_if(all.begin(), all.end(),
+                               [&](const baked::Object &object) {
+                                   return string(object.name) == name;
+                               });
+    return result == all.end() ? nullptr : &*result;
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include "MappedFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// On-disk layout of a baked level. Every record is plain old data so the file
+// can be memory-mapped and read in place. Sections are 8-byte aligned and
+// stored in native byte order.
+namespace baked {
+
+constexpr uint32_t MAGIC = 0x4c564c50; // "PLVL"
+constexpr uint32_t VERSION = 3;
+
+// Tiled stores flip flags in the three high bits of every gid.
+constexpr uint32_t FLIPPED_HORIZONTALLY = 0x80000000u;
+constexpr uint32_t FLIPPED_VERTICALLY = 0x40000000u;
+constexpr uint32_t FLIPPED_DIAGONALLY = 0x20000000u;
+constexpr uint32_t FLIP_FLAGS =
+    FLIPPED_HORIZONTALLY | FLIPPED_VERTICALLY | FLIPPED_DIAGONALLY;
+constexpr uint32_t gidOf(uint32_t cell) { return cell & ~FLIP_FLAGS; }
+
+// How characters collide with a tile, from its type in Tiled. Tiles without
+// one are solid when they have collision shapes.
+constexpr uint32_t COLLISION_NONE = 0;
+constexpr uint32_t COLLISION_SOLID = 1;
+constexpr uint32_t COLLISION_ONE_WAY = 2;       // Only stops falling
+constexpr uint32_t COLLISION_SLOPE_RISING = 3;  // Floor goes up to the right
+constexpr uint32_t COLLISION_SLOPE_FALLING = 4; // Floor goes down to the right
+
+struct Section {
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct StringRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct Rect {
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+struct Point {
+    float x;
+    float y;
+};
+
+struct Loop {
+    uint32_t firstPoint;
+    uint32_t pointCount;
+};
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;          // Map width in tiles
+    int32_t height;         // Map height in tiles
+    int32_t tileWidth;      // Tile width in pixels
+    int32_t tileHeight;     // Tile height in pixels
+
+    Section tilesets;       // Tileset[]
+    Section tiles;          // Tile[], indexed by gid
+    Section tileShapes;     // Rect[], referenced by Tile
+    Section grid;           // uint32_t[width * height], row-major gids
+    Section colliders;      // Rect[], merged from tile shapes and colliders
+    Section colliderPoints; // Point[], referenced by Loop
+    Section colliderLoops;  // Loop[], outlines of the merged geometry
+    Section objects;        // Object[], from the object layer
+    Section strings;        // char[]
+};
+
+struct Tileset {
+    uint32_t firstGid;
+    uint32_t tileCount;
+    int32_t imageWidth;
+    int32_t imageHeight;
+    StringRef image; // Relative to the level file
+};
+
+struct Tile {
+    uint32_t tileset;   // Index into the tileset section
+    uint32_t firstShape;
+    uint32_t shapeCount;
+    uint32_t collision; // COLLISION_*
+    Rect source;        // Pixel rectangle inside the tileset image
+};
+
+struct Object {
+    StringRef name;
+    StringRef type;
+    Rect bounds;
+};
+
+} // namespace baked
+
+// Read-only view over a baked level, either memory-mapped from disk or backed
+// by an in-memory buffer produced by the baker.
+class BakedLevel {
+
+  public:
+    BakedLevel() = default;
+    BakedLevel(const BakedLevel &) = delete;
+    BakedLevel &operator=(const BakedLevel &) = delete;
+    BakedLevel(BakedLevel &&other) noexcept;
+    BakedLevel &operator=(BakedLevel &&other) noexcept;
+    ~BakedLevel();
+
+    bool open(const std::filesystem::path &path);
+    bool adopt(std::vector<std::byte> bytes);
+    bool isOpen() const { return header != nullptr; }
+
+    int width() const { return header->width; }
+    int height() const { return header->height; }
+    int tileWidth() const { return header->tileWidth; }
+    int tileHeight() const { return header->tileHeight; }
+
+    std::span<const baked::Tileset> tilesets() const;
+    std::span<const baked::Tile> tiles() const;
+    std::span<const baked::Rect> tileShapes() const;
+    std::span<const uint32_t> grid() const;
+    std::span<const baked::Rect> colliders() const;
+    std::span<const baked::Point> colliderPoints() const;
+    std::span<const baked::Loop> colliderLoops() const;
+    std::span<const baked::Object> objects() const;
+    std::string_view string(baked::StringRef ref) const;
+
+    const baked::Tile *tile(uint32_t cell) const;
+    const baked::Object *firstObject(std::string_view name) const;
+
+  private:
+    template <typename T> std::span<const T> section(baked::Section s) const {
+        return {reinterpret_cast<const T *>(data + s.offset),
+                static_cast<size_t>(s.count)};
+    }
+
+    bool validate();
+    bool validateReferences(const baked::Header &candidate) const;
+    void close();
+
+    const std::byte *data = nullptr;
+    size_t size = 0;
+    const baked::Header *header = nullptr;
+
+    MappedFile file;
+    std::vector<std::byte> owned;
+};
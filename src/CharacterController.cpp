@@ -0,0 +1,234 @@
+#include "CharacterController.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Overlap tolerated without counting as a collision, so rounding errors do
+// not snag characters on the floor they stand on or the wall they touch.
+constexpr float SKIN = 0.01f;
+constexpr float NO_FLOOR = std::numeric_limits<float>::infinity();
+
+// Cells containing a pixel coordinate.
+int cellOf(float px, int size) {
+    return static_cast<int>(std::floor(px / static_cast<float>(size)));
+}
+
+bool solidIn(const CollisionGrid &grid, int x0, int y0, int x1, int y1) {
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            if (grid.at(x, y) == TileCollision::Solid) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// The highest floor between up pixels above and down pixels below the feet:
+// the top of a solid (or one-way) cell under the box, at or below the feet,
+// or the surface of a slope under the centre.
+float findFloor(const CollisionGrid &grid, const CharacterComponent &c,
+                float up, float down, bool oneWay) {
+    const int tileWidth = grid.tileWidth();
+    const int tileHeight = grid.tileHeight();
+    const int col0 = cellOf(c.x - c.halfWidth + SKIN, tileWidth);
+    const int col1 = cellOf(c.x + c.halfWidth - SKIN, tileWidth);
+    const int row0 = static_cast<int>(
+        std::ceil((c.y - SKIN) / static_cast<float>(tileHeight)));
+    const int row1 = cellOf(c.y + down, tileHeight);
+
+    float floor = NO_FLOOR;
+    for (int row = row0; row <= row1 && floor == NO_FLOOR; ++row) {
+        for (int col = col0; col <= col1; ++col) {
+            TileCollision cell = grid.at(col, row);
+            if (cell == TileCollision::Solid ||
+                (cell == TileCollision::OneWay && oneWay)) {
+                floor = static_cast<float>(row * tileHeight);
+                break;
+            }
+        }
+    }
+
+    const int centre = cellOf(c.x, tileWidth);
+    for (int row = cellOf(c.y - up, tileHeight);
+         row <= cellOf(c.y + down, tileHeight); ++row) {
+        TileCollision cell = grid.at(centre, row);
+        if (cell == TileCollision::SlopeRising ||
+            cell == TileCollision::SlopeFalling) {
+            float surface = grid.slopeFloor(cell, centre, row, c.x);
+            if (surface >= c.y - up && surface <= c.y + down) {
+                floor = std::min(floor, surface);
+            }
+        }
+    }
+    return floor;
+}
+
+// Lifts a character on the ground onto the solid cells of column col when
+// their top is at most stepHeight above its feet and there is room for it.
+// Walking up a slope may have carried it up to slack pixels past that.
+bool stepUp(const CollisionGrid &grid, CharacterComponent &c, int col,
+            float slack) {
+    if (!c.onGround || c.stepHeight <= 0.0f) {
+        return false;
+    }
+    const int tileWidth = grid.tileWidth();
+    const int tileHeight = grid.tileHeight();
+    const int headRow = cellOf(c.y - c.height + SKIN, tileHeight);
+    const int feetRow = cellOf(c.y - SKIN, tileHeight);
+    const float reach = c.stepHeight + slack;
+    const int stepRow = std::max(headRow, cellOf(c.y - reach, tileHeight));
+    if (solidIn(grid, col, headRow, col, stepRow - 1)) {
+        return false; // A wall, not a step
+    }
+
+    float top = c.y;
+    for (int row = stepRow; row <= feetRow; ++row) {
+        if (grid.at(col, row) == TileCollision::Solid) {
+            top = static_cast<float>(row * tileHeight);
+            break;
+        }
+    }
+    if (c.y - top > reach) {
+        return false;
+    }
+
+    const int raisedHead = cellOf(top - c.height + SKIN, tileHeight);
+    const int raisedFeet = cellOf(top - SKIN, tileHeight);
+    if (solidIn(grid, cellOf(c.x - c.halfWidth + SKIN, tileWidth), raisedHead,
+                cellOf(c.x + c.halfWidth - SKIN, tileWidth), raisedFeet) ||
+        solidIn(grid, col, raisedHead, col, raisedFeet)) {
+        return false;
+    }
+    c.y = top;
+    return true;
+}
+
+void moveX(const CollisionGrid &grid, CharacterComponent &c, float dx) {
+    if (dx == 0.0f) {
+        return;
+    }
+    const int tileWidth = grid.tileWidth();
+    const int tileHeight = grid.tileHeight();
+    // Slopes and one-way cells never block sideways.
+    const float slack = std::abs(dx) * tileHeight / tileWidth;
+    auto blocked = [&](int col) {
+        return solidIn(grid, col, cellOf(c.y - c.height + SKIN, tileHeight),
+                       col, cellOf(c.y - SKIN, tileHeight)) &&
+               !stepUp(grid, c, col, slack);
+    };
+
+    if (dx > 0.0f) {
+        const float right = c.x + c.halfWidth;
+        for (int col = cellOf(right - SKIN, tileWidth);
+             col <= cellOf(right + dx - SKIN, tileWidth); ++col) {
+            if (blocked(col)) {
+                c.x = std::max(c.x, col * tileWidth - c.halfWidth);
+                c.xVelocity = 0.0f;
+                return;
+            }
+        }
+    } else {
+        const float left = c.x - c.halfWidth;
+        for (int col = cellOf(left + SKIN, tileWidth);
+             col >= cellOf(left + dx + SKIN, tileWidth); --col) {
+            if (blocked(col)) {
+                c.x = std::min(c.x, (col + 1) * tileWidth + c.halfWidth);
+                c.xVelocity = 0.0f;
+                return;
+            }
+        }
+    }
+    c.x += dx;
+}
+
+void moveY(const CollisionGrid &grid, CharacterComponent &c, float dy,
+           float slopeRise) {
+    const int tileWidth = grid.tileWidth();
+    const int tileHeight = grid.tileHeight();
+    if (dy >= 0.0f) {
+        float floor = findFloor(grid, c, slopeRise, dy, !c.dropDown);
+        if (floor != NO_FLOOR) {
+            c.y = floor;
+            c.yVelocity = 0.0f;
+            c.onGround = true;
+        } else {
+            c.y += dy;
+            c.onGround = false;
+        }
+        return;
+    }
+
+    // Only solid cells stop a character going up.
+    c.onGround = false;
+    const float top = c.y - c.height;
+    const int col0 = cellOf(c.x - c.halfWidth + SKIN, tileWidth);
+    const int col1 = cellOf(c.x + c.halfWidth - SKIN, tileWidth);
+    for (int row = cellOf(top + SKIN, tileHeight) - 1;
+         row >= cellOf(top + dy, tileHeight); --row) {
+        if (solidIn(grid, col0, row, col1, row)) {
+            c.y = static_cast<float>((row + 1) * tileHeight) + c.height;
+            c.yVelocity = 0.0f;
+            return;
+        }
+    }
+    c.y += dy;
+}
+
+} // namespace
+
+void moveCharacter(const CollisionGrid &grid, CharacterComponent &character,
+                   float dt) {
+    CharacterComponent &c = character;
+    c.previousX = c.x;
+    c.previousY = c.y;
+    c.yVelocity = std::min(c.yVelocity + CHARACTER_GRAVITY * dt,
+                           CHARACTER_MAX_FALL_SPEED);
+
+    const bool wasOnGround = c.onGround;
+    const float dx = c.xVelocity * dt;
+    const float dy = c.yVelocity * dt;
+    moveX(grid, c, dx);
+
+    // A slope can rise or fall under a character moving sideways by at most
+    // its gradient times dx.
+    const float slopeRise = std::abs(dx) * grid.tileHeight() / grid.tileWidth();
+
+    // Stay on the ground over slopes and small steps down instead of
+    // flying off them.
+    if (wasOnGround && dy >= 0.0f) {
+        const float reach = c.stepHeight + slopeRise;
+        float floor = findFloor(grid, c, reach, reach + dy, !c.dropDown);
+        if (floor != NO_FLOOR) {
+            c.y = floor;
+            c.yVelocity = 0.0f;
+            c.dropDown = false;
+            return;
+        }
+    }
+
+    moveY(grid, c, dy, slopeRise);
+    c.dropDown = false;
+}
+
+void moveCharacters(entt::registry &registry, const CollisionGrid &grid,
+                    const ActivityRegions &activity, float dt) {
+    registry
+        .view<CharacterComponent>(
+            entt::exclude<DormantComponent, TickRateComponent>)
+        .each([&grid, dt](CharacterComponent &character) {
+            moveCharacter(grid, character, dt);
+        });
+    registry
+        .view<CharacterComponent, TickRateComponent>(
+            entt::exclude<DormantComponent>)
+        .each([&grid, &activity, dt](entt::entity entity,
+                                     CharacterComponent &character,
+                                     TickRateComponent &rate) {
+            if (uint32_t steps = activity.dueSteps(entity, rate)) {
+                moveCharacter(grid, character, static_cast<float>(steps) * dt);
+            }
+        });
+}
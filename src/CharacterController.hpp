@@ -0,0 +1,21 @@
+#pragma once
+#include <entt/entt.hpp>
+#include "ActivityRegions.hpp"
+#include "CollisionGrid.hpp"
+#include "components.hpp"
+
+// Box2D's gravity of 10 m/s^2 at 16 pixels per metre.
+constexpr float CHARACTER_GRAVITY = 160.0f;
+constexpr float CHARACTER_MAX_FALL_SPEED = 600.0f;
+
+// Moves a character by its velocity over one time step: gravity, then a
+// swept move along x and one along y against the collision grid, so nothing
+// tunnels however fast it goes. On the ground it follows slopes and steps
+// up and down ledges up to its stepHeight.
+void moveCharacter(const CollisionGrid &grid, CharacterComponent &character,
+                   float dt);
+
+// moveCharacter() for every character that is not dormant and, per its tick
+// rate, due on this step, by as many steps of dt as it skipped.
+void moveCharacters(entt::registry &registry, const CollisionGrid &grid,
+                    const ActivityRegions &activity, float dt);
@@ -0,0 +1,231 @@
+#include "ColliderBaker.hpp"
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+
+namespace {
+
+// The union of the input rectangles rasterized onto the grid formed by their
+// distinct edge coordinates. Every cell is either fully solid or fully empty.
+struct SolidGrid {
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<uint8_t> solid;
+    int width = 0;  // Cells per row, xs.size() - 1
+    int height = 0; // Rows, ys.size() - 1
+
+    bool at(int x, int y) const {
+        return x >= 0 && y >= 0 && x < width && y < height &&
+               solid[static_cast<size_t>(y) * width + x];
+    }
+};
+
+std::vector<float> uniqueEdges(std::vector<float> edges) {
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+int edgeIndex(const std::vector<float> &edges, float value) {
+    return static_cast<int>(
+        std::lower_bound(edges.begin(), edges.end(), value) - edges.begin());
+}
+
+SolidGrid rasterize(std::span<const baked::Rect> rects) {
+    SolidGrid grid;
+    std::vector<float> xs;
+    std::vector<float> ys;
+    for (const baked::Rect &rect : rects) {
+        if (rect.width <= 0.0f || rect.height <= 0.0f) {
+            continue;
+        }
+        xs.insert(xs.end(), {rect.x, rect.x + rect.width});
+        ys.insert(ys.end(), {rect.y, rect.y + rect.height});
+    }
+    grid.xs = uniqueEdges(std::move(xs));
+    grid.ys = uniqueEdges(std::move(ys));
+    if (grid.xs.size() < 2 || grid.ys.size() < 2) {
+        return grid;
+    }
+    grid.width = static_cast<int>(grid.xs.size()) - 1;
+    grid.height = static_cast<int>(grid.ys.size()) - 1;
+
+    // 2D difference array, so every rectangle costs O(1) regardless of how
+    // many cells it covers.
+    const int stride = grid.width + 1;
+    std::vector<int32_t> coverage(static_cast<size_t>(stride) *
+                                      (grid.height + 1),
+                                  0);
+    for (const baked::Rect &rect : rects) {
+        if (rect.width <= 0.0f || rect.height <= 0.0f) {
+            continue;
+        }
+        int x0 = edgeIndex(grid.xs, rect.x);
+        int x1 = edgeIndex(grid.xs, rect.x + rect.width);
+        int y0 = edgeIndex(grid.ys, rect.y);
+        int y1 = edgeIndex(grid.ys, rect.y + rect.height);
+        coverage[y0 * stride + x0] += 1;
+        coverage[y0 * stride + x1] -= 1;
+        coverage[y1 * stride + x0] -= 1;
+        coverage[y1 * stride + x1] += 1;
+    }
+
+    grid.solid.assign(static_cast<size_t>(grid.width) * grid.height, 0);
+    std::vector<int32_t> column(grid.width + 1, 0);
+    for (int y = 0; y < grid.height; ++y) {
+        int32_t running = 0;
+        for (int x = 0; x < grid.width; ++x) {
+            column[x] += coverage[y * stride + x];
+            running += column[x];
+            grid.solid[static_cast<size_t>(y) * grid.width + x] = running > 0;
+        }
+    }
+    return grid;
+}
+
+// Greedy meshing: grow each box right as far as possible, then down while
+// the whole row below is solid and unclaimed.
+std::vector<baked::Rect> greedyBoxes(const SolidGrid &grid) {
+    std::vector<baked::Rect> boxes;
+    std::vector<uint8_t> claimed(grid.solid.size(), 0);
+    auto isFree = [&](int x, int y) {
+        size_t i = static_cast<size_t>(y) * grid.width + x;
+        return grid.solid[i] && !claimed[i];
+    };
+    auto isRowFree = [&](int x0, int x1, int y) {
+        for (int x = x0; x < x1; ++x) {
+            if (!isFree(x, y)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (int y = 0; y < grid.height; ++y) {
+        for (int x = 0; x < grid.width; ++x) {
+            if (!isFree(x, y)) {
+                continue;
+            }
+            int x1 = x + 1;
+            while (x1 < grid.width && isFree(x1, y)) {
+                ++x1;
+            }
+            int y1 = y + 1;
+            while (y1 < grid.height && isRowFree(x, x1, y1)) {
+                ++y1;
+            }
+            for (int row = y; row < y1; ++row) {
+                std::fill_n(claimed.begin() +
+                                static_cast<size_t>(row) * grid.width + x,
+                            x1 - x, 1);
+            }
+            boxes.push_back({grid.xs[x], grid.ys[y], grid.xs[x1] - grid.xs[x],
+                             grid.ys[y1] - grid.ys[y]});
+        }
+    }
+    return boxes;
+}
+
+struct Edge {
+    int x0, y0; // Start vertex, in grid edge indices
+    int x1, y1; // End vertex
+};
+
+uint64_t vertexKey(int x, int y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) |
+           static_cast<uint32_t>(x);
+}
+
+// Walks the boundary between solid and empty cells. Edges keep the solid side
+// on their left; where two regions touch only at a corner the walk turns
+// left, which keeps every outline free of self-intersections.
+void traceOutlines(const SolidGrid &grid, MergedColliders &merged) {
+    std::vector<Edge> edges;
+    for (int y = 0; y < grid.height; ++y) {
+        for (int x = 0; x < grid.width; ++x) {
+            if (!grid.at(x, y)) {
+                continue;
+            }
+            if (!grid.at(x, y - 1)) {
+                edges.push_back({x, y, x + 1, y});
+            }
+            if (!grid.at(x + 1, y)) {
+                edges.push_back({x + 1, y, x + 1, y + 1});
+            }
+            if (!grid.at(x, y + 1)) {
+                edges.push_back({x + 1, y + 1, x, y + 1});
+            }
+            if (!grid.at(x - 1, y)) {
+                edges.push_back({x, y + 1, x, y});
+            }
+        }
+    }
+
+    // A grid vertex starts at most two boundary edges.
+    std::unordered_map<uint64_t, std::array<int32_t, 2>> outgoing;
+    outgoing.reserve(edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+        auto [slot, inserted] =
+            outgoing.try_emplace(vertexKey(edges[i].x0, edges[i].y0),
+                                 std::array<int32_t, 2>{-1, -1});
+        slot->second[slot->second[0] < 0 ? 0 : 1] = static_cast<int32_t>(i);
+    }
+
+    std::vector<uint8_t> used(edges.size(), 0);
+    std::vector<Edge> loop;
+    for (size_t first = 0; first < edges.size(); ++first) {
+        if (used[first]) {
+            continue;
+        }
+
+        loop.clear();
+        size_t current = first;
+        while (!used[current]) {
+            used[current] = 1;
+            const Edge &edge = edges[current];
+            loop.push_back(edge);
+
+            const std::array<int32_t, 2> &candidates =
+                outgoing.at(vertexKey(edge.x1, edge.y1));
+            int32_t next = candidates[0];
+            if (candidates[1] >= 0) {
+                const Edge &a = edges[candidates[0]];
+                int inX = edge.x1 - edge.x0;
+                int inY = edge.y1 - edge.y0;
+                int cross = inX * (a.y1 - a.y0) - inY * (a.x1 - a.x0);
+                next = cross > 0 ? candidates[0] : candidates[1];
+            }
+            current = static_cast<size_t>(next);
+        }
+
+        // Keep only the corners; the compressed grid splits straight runs.
+        baked::Loop outline{static_cast<uint32_t>(merged.points.size()), 0};
+        for (size_t i = 0; i < loop.size(); ++i) {
+            const Edge &in = loop[(i + loop.size() - 1) % loop.size()];
+            const Edge &out = loop[i];
+            int inX = in.x1 - in.x0;
+            int inY = in.y1 - in.y0;
+            int outX = out.x1 - out.x0;
+            int outY = out.y1 - out.y0;
+            if (inX * outY - inY * outX != 0) {
+                merged.points.push_back({grid.xs[out.x0], grid.ys[out.y0]});
+            }
+        }
+        outline.pointCount =
+            static_cast<uint32_t>(merged.points.size()) - outline.firstPoint;
+        merged.loops.push_back(outline);
+    }
+}
+
+} // namespace
+
+MergedColliders mergeColliders(std::span<const baked::Rect> rects) {
+    MergedColliders merged;
+    SolidGrid grid = rasterize(rects);
+    if (grid.width == 0 || grid.height == 0) {
+        return merged;
+    }
+    merged.boxes = greedyBoxes(grid);
+    traceOutlines(grid, merged);
+    return merged;
+}
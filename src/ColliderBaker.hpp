@@ -0,0 +1,15 @@
+#pragma once
+#include "BakedLevel.hpp"
+#include <span>
+#include <vector>
+
+// Static level geometry after merging: the union of all input rectangles as
+// a few large boxes, and as closed outlines with the solid side on the left
+// of each edge (outer outlines counter-clockwise, holes clockwise).
+struct MergedColliders {
+    std::vector<baked::Rect> boxes;
+    std::vector<baked::Point> points;
+    std::vector<baked::Loop> loops; // Ranges into points
+};
+
+MergedColliders mergeColliders(std::span<const baked::Rect> rects);
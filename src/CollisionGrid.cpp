@@ -0,0 +1,62 @@
+#include "CollisionGrid.hpp"
+#include <algorithm>
+
+CollisionGrid::CollisionGrid(const TileLayer &layer)
+    : gridWidth(layer.width()), gridHeight(layer.height()),
+      cellWidth(layer.tileWidth()), cellHeight(layer.tileHeight()),
+      cells(static_cast<size_t>(gridWidth) * gridHeight + GATHER_PADDING) {
+    for (int y = 0; y < gridHeight; ++y) {
+        for (int x = 0; x < gridWidth; ++x) {
+            cells[static_cast<size_t>(y) * gridWidth + x] =
+                collisionOf(layer, x, y);
+        }
+    }
+}
+
+void CollisionGrid::setCell(const TileLayer &layer, int x, int y) {
+    if (x >= 0 && y >= 0 && x < gridWidth && y < gridHeight) {
+        cells[static_cast<size_t>(y) * gridWidth + x] =
+            collisionOf(layer, x, y);
+    }
+}
+
+TileCollision CollisionGrid::collisionOf(const TileLayer &layer, int x,
+                                         int y) {
+    const baked::Tile *tile = layer.getTile(x, y);
+    if (tile == nullptr) {
+        return TileCollision::Empty;
+    }
+    const uint32_t cell = layer.getCell(x, y);
+    switch (tile->collision) {
+    case baked::COLLISION_SOLID:
+        return TileCollision::Solid;
+    case baked::COLLISION_ONE_WAY:
+        return TileCollision::OneWay;
+    case baked::COLLISION_SLOPE_RISING:
+    case baked::COLLISION_SLOPE_FALLING: {
+        // Upside-down slopes would be ceilings, which the controller does
+        // not know; they block like solid tiles instead.
+        if (cell & (baked::FLIPPED_VERTICALLY | baked::FLIPPED_DIAGONALLY)) {
+            return TileCollision::Solid;
+        }
+        bool rising = tile->collision == baked::COLLISION_SLOPE_RISING;
+        if (cell & baked::FLIPPED_HORIZONTALLY) {
+            rising = !rising;
+        }
+        return rising ? TileCollision::SlopeRising
+                      : TileCollision::SlopeFalling;
+    }
+    default:
+        return TileCollision::Empty;
+    }
+}
+
+float CollisionGrid::slopeFloor(TileCollision slope, int cellX, int cellY,
+                                float px) const {
+    const float left = static_cast<float>(cellX * cellWidth);
+    const float t = std::clamp((px - left) / cellWidth, 0.0f, 1.0f);
+    const float top = static_cast<float>(cellY * cellHeight);
+    return slope == TileCollision::SlopeRising
+               ? top + (1.0f - t) * cellHeight
+               : top + t * cellHeight;
+}
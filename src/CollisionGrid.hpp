@@ -0,0 +1,58 @@
+#pragma once
+#include "TileLayer.hpp"
+#include <cstdint>
+#include <vector>
+
+enum class TileCollision : uint8_t {
+    Empty,
+    Solid,
+    OneWay,       // Stops only what falls onto its top
+    SlopeRising,  // Floor from the bottom left to the top right corner
+    SlopeFalling, // Floor from the top left to the bottom right corner
+};
+
+// One byte per cell saying how characters collide with it, so the character
+// controller never has to look at tiles or their shapes. Solid and one-way
+// cells fill their whole cell. Built once from the tile layer; call
+// setCell() along with TileLayer::setCell().
+class CollisionGrid {
+
+  public:
+    CollisionGrid() = default;
+    explicit CollisionGrid(const TileLayer &layer);
+
+    int width() const { return gridWidth; }
+    int height() const { return gridHeight; }
+    int tileWidth() const { return cellWidth; }
+    int tileHeight() const { return cellHeight; }
+
+    // Empty outside the map.
+    TileCollision at(int x, int y) const {
+        if (x < 0 || y < 0 || x >= gridWidth || y >= gridHeight) {
+            return TileCollision::Empty;
+        }
+        return cells[static_cast<size_t>(y) * gridWidth + x];
+    }
+
+    // Row-major cells, followed by GATHER_PADDING empty bytes so a 32-bit
+    // load at any cell stays inside the buffer.
+    const TileCollision *data() const { return cells.data(); }
+
+    // Picks up the new tile at x, y of layer.
+    void setCell(const TileLayer &layer, int x, int y);
+
+    // Height of the floor of a slope cell at pixel column px, as a pixel y.
+    float slopeFloor(TileCollision slope, int cellX, int cellY,
+                     float px) const;
+
+    static constexpr size_t GATHER_PADDING = 3;
+
+  private:
+    static TileCollision collisionOf(const TileLayer &layer, int x, int y);
+
+    int gridWidth = 0;
+    int gridHeight = 0;
+    int cellWidth = 0;
+    int cellHeight = 0;
+    std::vector<TileCollision> cells;
+};
@@ -0,0 +1,64 @@
+#include "GroundContacts.hpp"
+#include "box2d/b2_contact.h"
+#include "box2d/b2_polygon_shape.h"
+#include "components.hpp"
+#include <cstdint>
+
+// Foot sensors store their entity plus one in the fixture's user data, so
+// zero still means "not a foot sensor".
+static uintptr_t sensorData(entt::entity entity) {
+    return static_cast<uintptr_t>(entt::to_integral(entity)) + 1;
+}
+
+static entt::entity sensorEntity(uintptr_t data) {
+    return static_cast<entt::entity>(data - 1);
+}
+
+void GroundContactListener::BeginContact(b2Contact *contact) {
+    count(contact, 1);
+}
+
+void GroundContactListener::EndContact(b2Contact *contact) {
+    count(contact, -1);
+}
+
+void GroundContactListener::count(b2Contact *contact, int delta) {
+    b2Fixture *fixtures[] = {contact->GetFixtureA(), contact->GetFixtureB()};
+    for (int i = 0; i < 2; ++i) {
+        b2Fixture *sensor = fixtures[i];
+        b2Fixture *other = fixtures[1 - i];
+        uintptr_t data = sensor->GetUserData().pointer;
+        // Only solid fixtures of other bodies are ground.
+        if (data == 0 || other->IsSensor() ||
+            other->GetBody() == sensor->GetBody()) {
+            continue;
+        }
+
+        entt::entity entity = sensorEntity(data);
+        if (!registry.valid(entity)) {
+            continue; // Destroyed before its body
+        }
+        auto *ground = registry.try_get<GroundSensorComponent>(entity);
+        if (ground == nullptr) {
+            continue;
+        }
+        ground->contacts += delta;
+        if (auto *physC = registry.try_get<PhysicsComponent>(entity)) {
+            physC->isOnGround = ground->contacts > 0;
+        }
+    }
+}
+
+b2Fixture *addFootSensor(entt::registry &registry, entt::entity entity,
+                         b2Body *body, float halfWidth, float halfHeight) {
+    // Slightly narrower than the body so walls do not count as ground.
+    b2PolygonShape foot;
+    foot.SetAsBox(halfWidth * 0.9f, halfHeight * 0.1f, {0.0f, halfHeight},
+                  0.0f);
+    b2FixtureDef sensorDef;
+    sensorDef.shape = &foot;
+    sensorDef.isSensor = true;
+    sensorDef.userData.pointer = sensorData(entity);
+    registry.emplace<GroundSensorComponent>(entity);
+    return body->CreateFixture(&sensorDef);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <entt/entt.hpp>
+#include "box2d/b2_body.h"
+#include "box2d/b2_fixture.h"
+#include "box2d/b2_world_callbacks.h"
+
+// Tracks which entities stand on something, from Box2D's begin and end
+// contact events on their foot sensors. Keeps GroundSensorComponent and
+// PhysicsComponent::isOnGround up to date, so nothing has to look at
+// contacts per step.
+class GroundContactListener : public b2ContactListener {
+
+  public:
+    explicit GroundContactListener(entt::registry &registry)
+        : registry(registry) {}
+
+    void BeginContact(b2Contact *contact) override;
+    void EndContact(b2Contact *contact) override;
+
+  private:
+    void count(b2Contact *contact, int delta);
+
+    entt::registry &registry;
+};
+
+// Adds a thin sensor along the bottom of a box of halfWidth x halfHeight
+// centred on body, in Box2D units, and gives entity a GroundSensorComponent.
+b2Fixture *addFootSensor(entt::registry &registry, entt::entity entity,
+                         b2Body *body, float halfWidth, float halfHeight);
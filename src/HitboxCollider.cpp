@@ -0,0 +1,285 @@
+#include "HitboxCollider.hpp"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) &&                             \
+    (defined(__GNUC__) || defined(__clang__))
+#define HITBOX_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+int solidAt(const CollisionGrid &grid, int x, int y) {
+    return grid.at(x, y) == TileCollision::Solid ? 1 : 0;
+}
+
+// Boxes from begin on, one at a time. The SIMD versions below compute the
+// same thing, lane by lane, with the same float operations.
+void collideScalar(const CollisionGrid &grid, const HitboxBatch &boxes,
+                   size_t begin, HitboxPushes &pushes) {
+    const auto tileWidth = static_cast<float>(grid.tileWidth());
+    const auto tileHeight = static_cast<float>(grid.tileHeight());
+    for (size_t i = begin; i < boxes.size(); ++i) {
+        // Cells under the corners; the right and bottom edges are exclusive.
+        const float x0 = std::floor(boxes.left[i] / tileWidth);
+        const float x1 = std::ceil(boxes.right[i] / tileWidth) - 1.0f;
+        const float y0 = std::floor(boxes.top[i] / tileHeight);
+        const float y1 = std::ceil(boxes.bottom[i] / tileHeight) - 1.0f;
+        const int topLeft =
+            solidAt(grid, static_cast<int>(x0), static_cast<int>(y0));
+        const int topRight =
+            solidAt(grid, static_cast<int>(x1), static_cast<int>(y0));
+        const int bottomLeft =
+            solidAt(grid, static_cast<int>(x0), static_cast<int>(y1));
+        const int bottomRight =
+            solidAt(grid, static_cast<int>(x1), static_cast<int>(y1));
+
+        // Away from the side with more solid corners
+        const int left = topLeft + bottomLeft;
+        const int right = topRight + bottomRight;
+        const int top = topLeft + topRight;
+        const int bottom = bottomLeft + bottomRight;
+        float x = 0.0f;
+        if (left > right) {
+            x = (x0 + 1.0f) * tileWidth - boxes.left[i];
+        } else if (right > left) {
+            x = x1 * tileWidth - boxes.right[i];
+        }
+        float y = 0.0f;
+        if (top > bottom) {
+            y = (y0 + 1.0f) * tileHeight - boxes.top[i];
+        } else if (bottom > top) {
+            y = y1 * tileHeight - boxes.bottom[i];
+        }
+
+        // A lone corner needs only the shorter of the two pushes.
+        const int corners = left + right;
+        if (corners == 1) {
+            if (std::abs(x) < std::abs(y)) {
+                y = 0.0f;
+            } else {
+                x = 0.0f;
+            }
+        }
+        pushes.x[i] = x;
+        pushes.y[i] = y;
+        pushes.hit[i] = corners != 0 ? 1 : 0;
+    }
+}
+
+#ifdef HITBOX_X86
+
+// 1 in the lanes whose cell x, y is solid, 0 elsewhere. Cells outside the
+// grid read cell 0 and are masked off afterwards.
+__attribute__((target("avx2"))) __m256i solidAvx2(const int *cells,
+                                                  __m256i width,
+                                                  __m256i height, __m256i x,
+                                                  __m256i y) {
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    const __m256i inside = _mm256_and_si256(
+        _mm256_and_si256(_mm256_cmpgt_epi32(x, minusOne),
+                         _mm256_cmpgt_epi32(width, x)),
+        _mm256_and_si256(_mm256_cmpgt_epi32(y, minusOne),
+                         _mm256_cmpgt_epi32(height, y)));
+    const __m256i index = _mm256_and_si256(
+        inside, _mm256_add_epi32(_mm256_mullo_epi32(y, width), x));
+    const __m256i cell =
+        _mm256_and_si256(_mm256_i32gather_epi32(cells, index, 1),
+                         _mm256_set1_epi32(0xff));
+    const __m256i solid = _mm256_cmpeq_epi32(
+        cell, _mm256_set1_epi32(static_cast<int>(TileCollision::Solid)));
+    return _mm256_and_si256(_mm256_and_si256(inside, solid),
+                            _mm256_set1_epi32(1));
+}
+
+// Eight boxes at a time, cells fetched with gathers.
+// @return The number of boxes done
+__attribute__((target("avx2"))) size_t collideAvx2(const CollisionGrid &grid,
+                                                   const HitboxBatch &boxes,
+                                                   HitboxPushes &pushes) {
+    const auto *cells = reinterpret_cast<const int *>(grid.data());
+    const __m256i width = _mm256_set1_epi32(grid.width());
+    const __m256i height = _mm256_set1_epi32(grid.height());
+    const __m256 tileWidth =
+        _mm256_set1_ps(static_cast<float>(grid.tileWidth()));
+    const __m256 tileHeight =
+        _mm256_set1_ps(static_cast<float>(grid.tileHeight()));
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+    const size_t count = boxes.size() / 8 * 8;
+    for (size_t i = 0; i < count; i += 8) {
+        const __m256 boxLeft = _mm256_loadu_ps(boxes.left.data() + i);
+        const __m256 boxTop = _mm256_loadu_ps(boxes.top.data() + i);
+        const __m256 boxRight = _mm256_loadu_ps(boxes.right.data() + i);
+        const __m256 boxBottom = _mm256_loadu_ps(boxes.bottom.data() + i);
+        const __m256 x0 = _mm256_floor_ps(_mm256_div_ps(boxLeft, tileWidth));
+        const __m256 x1 = _mm256_sub_ps(
+            _mm256_ceil_ps(_mm256_div_ps(boxRight, tileWidth)), one);
+        const __m256 y0 = _mm256_floor_ps(_mm256_div_ps(boxTop, tileHeight));
+        const __m256 y1 = _mm256_sub_ps(
+            _mm256_ceil_ps(_mm256_div_ps(boxBottom, tileHeight)), one);
+        const __m256i cellX0 = _mm256_cvttps_epi32(x0);
+        const __m256i cellX1 = _mm256_cvttps_epi32(x1);
+        const __m256i cellY0 = _mm256_cvttps_epi32(y0);
+        const __m256i cellY1 = _mm256_cvttps_epi32(y1);
+        const __m256i topLeft = solidAvx2(cells, width, height, cellX0, cellY0);
+        const __m256i topRight =
+            solidAvx2(cells, width, height, cellX1, cellY0);
+        const __m256i bottomLeft =
+            solidAvx2(cells, width, height, cellX0, cellY1);
+        const __m256i bottomRight =
+            solidAvx2(cells, width, height, cellX1, cellY1);
+
+        const __m256i left = _mm256_add_epi32(topLeft, bottomLeft);
+        const __m256i right = _mm256_add_epi32(topRight, bottomRight);
+        const __m256i top = _mm256_add_epi32(topLeft, topRight);
+        const __m256i bottom = _mm256_add_epi32(bottomLeft, bottomRight);
+        __m256 x = _mm256_blendv_ps(
+            zero,
+            _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(x0, one), tileWidth),
+                          boxLeft),
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(left, right)));
+        x = _mm256_blendv_ps(
+            x, _mm256_sub_ps(_mm256_mul_ps(x1, tileWidth), boxRight),
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(right, left)));
+        __m256 y = _mm256_blendv_ps(
+            zero,
+            _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(y0, one), tileHeight),
+                          boxTop),
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(top, bottom)));
+        y = _mm256_blendv_ps(
+            y, _mm256_sub_ps(_mm256_mul_ps(y1, tileHeight), boxBottom),
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(bottom, top)));
+
+        const __m256i corners = _mm256_add_epi32(left, right);
+        const __m256 single = _mm256_castsi256_ps(
+            _mm256_cmpeq_epi32(corners, _mm256_set1_epi32(1)));
+        const __m256 keepX =
+            _mm256_cmp_ps(_mm256_and_ps(x, absMask),
+                          _mm256_and_ps(y, absMask), _CMP_LT_OQ);
+        _mm256_storeu_ps(pushes.x.data() + i,
+                         _mm256_andnot_ps(_mm256_andnot_ps(keepX, single), x));
+        _mm256_storeu_ps(pushes.y.data() + i,
+                         _mm256_andnot_ps(_mm256_and_ps(keepX, single), y));
+
+        const int hits = _mm256_movemask_ps(_mm256_castsi256_ps(
+            _mm256_cmpgt_epi32(corners, _mm256_setzero_si256())));
+        for (int lane = 0; lane < 8; ++lane) {
+            pushes.hit[i + lane] = static_cast<uint8_t>((hits >> lane) & 1);
+        }
+    }
+    return count;
+}
+
+// Four boxes at a time. SSE4.1 has no gathers, so the cells are looked up
+// one by one between the vector steps.
+// @return The number of boxes done
+__attribute__((target("sse4.1"))) size_t collideSse41(
+    const CollisionGrid &grid, const HitboxBatch &boxes,
+    HitboxPushes &pushes) {
+    const __m128 tileWidth = _mm_set1_ps(static_cast<float>(grid.tileWidth()));
+    const __m128 tileHeight =
+        _mm_set1_ps(static_cast<float>(grid.tileHeight()));
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+    const size_t count = boxes.size() / 4 * 4;
+    for (size_t i = 0; i < count; i += 4) {
+        const __m128 boxLeft = _mm_loadu_ps(boxes.left.data() + i);
+        const __m128 boxTop = _mm_loadu_ps(boxes.top.data() + i);
+        const __m128 boxRight = _mm_loadu_ps(boxes.right.data() + i);
+        const __m128 boxBottom = _mm_loadu_ps(boxes.bottom.data() + i);
+        const __m128 x0 = _mm_floor_ps(_mm_div_ps(boxLeft, tileWidth));
+        const __m128 x1 =
+            _mm_sub_ps(_mm_ceil_ps(_mm_div_ps(boxRight, tileWidth)), one);
+        const __m128 y0 = _mm_floor_ps(_mm_div_ps(boxTop, tileHeight));
+        const __m128 y1 =
+            _mm_sub_ps(_mm_ceil_ps(_mm_div_ps(boxBottom, tileHeight)), one);
+
+        alignas(16) int cellX0[4], cellX1[4], cellY0[4], cellY1[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(cellX0),
+                        _mm_cvttps_epi32(x0));
+        _mm_store_si128(reinterpret_cast<__m128i *>(cellX1),
+                        _mm_cvttps_epi32(x1));
+        _mm_store_si128(reinterpret_cast<__m128i *>(cellY0),
+                        _mm_cvttps_epi32(y0));
+        _mm_store_si128(reinterpret_cast<__m128i *>(cellY1),
+                        _mm_cvttps_epi32(y1));
+        alignas(16) int solid[4][4];
+        for (int lane = 0; lane < 4; ++lane) {
+            solid[0][lane] = solidAt(grid, cellX0[lane], cellY0[lane]);
+            solid[1][lane] = solidAt(grid, cellX1[lane], cellY0[lane]);
+            solid[2][lane] = solidAt(grid, cellX0[lane], cellY1[lane]);
+            solid[3][lane] = solidAt(grid, cellX1[lane], cellY1[lane]);
+        }
+        const __m128i topLeft =
+            _mm_load_si128(reinterpret_cast<const __m128i *>(solid[0]));
+        const __m128i topRight =
+            _mm_load_si128(reinterpret_cast<const __m128i *>(solid[1]));
+        const __m128i bottomLeft =
+            _mm_load_si128(reinterpret_cast<const __m128i *>(solid[2]));
+        const __m128i bottomRight =
+            _mm_load_si128(reinterpret_cast<const __m128i *>(solid[3]));
+
+        const __m128i left = _mm_add_epi32(topLeft, bottomLeft);
+        const __m128i right = _mm_add_epi32(topRight, bottomRight);
+        const __m128i top = _mm_add_epi32(topLeft, topRight);
+        const __m128i bottom = _mm_add_epi32(bottomLeft, bottomRight);
+        __m128 x = _mm_blendv_ps(
+            zero,
+            _mm_sub_ps(_mm_mul_ps(_mm_add_ps(x0, one), tileWidth), boxLeft),
+            _mm_castsi128_ps(_mm_cmpgt_epi32(left, right)));
+        x = _mm_blendv_ps(x, _mm_sub_ps(_mm_mul_ps(x1, tileWidth), boxRight),
+                          _mm_castsi128_ps(_mm_cmpgt_epi32(right, left)));
+        __m128 y = _mm_blendv_ps(
+            zero,
+            _mm_sub_ps(_mm_mul_ps(_mm_add_ps(y0, one), tileHeight), boxTop),
+            _mm_castsi128_ps(_mm_cmpgt_epi32(top, bottom)));
+        y = _mm_blendv_ps(y,
+                          _mm_sub_ps(_mm_mul_ps(y1, tileHeight), boxBottom),
+                          _mm_castsi128_ps(_mm_cmpgt_epi32(bottom, top)));
+
+        const __m128i corners = _mm_add_epi32(left, right);
+        const __m128 single =
+            _mm_castsi128_ps(_mm_cmpeq_epi32(corners, _mm_set1_epi32(1)));
+        const __m128 keepX =
+            _mm_cmplt_ps(_mm_and_ps(x, absMask), _mm_and_ps(y, absMask));
+        _mm_storeu_ps(pushes.x.data() + i,
+                      _mm_andnot_ps(_mm_andnot_ps(keepX, single), x));
+        _mm_storeu_ps(pushes.y.data() + i,
+                      _mm_andnot_ps(_mm_and_ps(keepX, single), y));
+
+        const int hits = _mm_movemask_ps(_mm_castsi128_ps(
+            _mm_cmpgt_epi32(corners, _mm_setzero_si128())));
+        for (int lane = 0; lane < 4; ++lane) {
+            pushes.hit[i + lane] = static_cast<uint8_t>((hits >> lane) & 1);
+        }
+    }
+    return count;
+}
+
+#endif
+
+} // namespace
+
+void collideHitboxes(const CollisionGrid &grid, const HitboxBatch &boxes,
+                     HitboxPushes &pushes) {
+    pushes.x.resize(boxes.size());
+    pushes.y.resize(boxes.size());
+    pushes.hit.resize(boxes.size());
+
+    size_t done = 0;
+#ifdef HITBOX_X86
+    // The gathers read the cell buffer, which an empty grid does not have.
+    if (grid.width() > 0 && grid.height() > 0 &&
+        __builtin_cpu_supports("avx2")) {
+        done = collideAvx2(grid, boxes, pushes);
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        done = collideSse41(grid, boxes, pushes);
+    }
+#endif
+    collideScalar(grid, boxes, done, pushes);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "CollisionGrid.hpp"
+#include "components.hpp"
+#include <cstdint>
+#include <vector>
+
+// Hitboxes in pixels, one array per edge, so the collider can load a whole
+// SIMD register of boxes at a time.
+struct HitboxBatch {
+    std::vector<float> left;
+    std::vector<float> top;
+    std::vector<float> right;
+    std::vector<float> bottom;
+
+    size_t size() const { return left.size(); }
+
+    void clear() {
+        left.clear();
+        top.clear();
+        right.clear();
+        bottom.clear();
+    }
+
+    // A hitbox relative to the position of its entity.
+    void add(float x, float y, const HitboxComponent &hitbox) {
+        left.push_back(x + hitbox.x);
+        top.push_back(y + hitbox.y);
+        right.push_back(x + hitbox.x + hitbox.width);
+        bottom.push_back(y + hitbox.y + hitbox.height);
+    }
+};
+
+// What collideHitboxes() found for each box of a batch, in the same order.
+struct HitboxPushes {
+    std::vector<float> x; // Move that takes the box out of the terrain
+    std::vector<float> y;
+    std::vector<uint8_t> hit; // 1 if the box overlaps a solid cell
+};
+
+// Resolves every box of boxes against the solid cells of grid, eight (AVX2)
+// or four (SSE4.1) boxes at a time when the CPU supports it. A box touching
+// one solid corner is pushed out along the shorter axis, one against a wall
+// or floor straight out of it, one in an inside corner out along both axes.
+// Boxes wedged between cells on opposite sides get hit without a push.
+// Meant for bullets and particles: only the cells under the corners are
+// looked at, so boxes must be no larger than a cell, and slopes and one-way
+// cells do not count.
+void collideHitboxes(const CollisionGrid &grid, const HitboxBatch &boxes,
+                     HitboxPushes &pushes);
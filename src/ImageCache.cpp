@@ -0,0 +1,174 @@
+#include "ImageCache.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t IMAGE_MAGIC = 0x474d4950; // "PIMG"
+constexpr uint32_t IMAGE_VERSION = 1;
+
+// Followed by width * height premultiplied RGBA8 pixels.
+struct ImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;
+    int32_t width;
+    int32_t height;
+};
+
+// 64-bit FNV-1a. Tileset PNGs are small, so this costs next to nothing
+// compared to decoding one.
+uint64_t hashBytes(std::span<const std::byte> bytes) {
+    uint64_t hash = 0xcbf29ce484222325u;
+    for (std::byte b : bytes) {
+        hash = (hash ^ static_cast<uint64_t>(b)) * 0x100000001b3u;
+    }
+    return hash;
+}
+
+// Named after the source file, a hash of its full path, so tilesets with the
+// same name in different directories get entries of their own, and a hash
+// of its contents.
+std::filesystem::path entryPath(const std::filesystem::path &source,
+                                const std::filesystem::path &cacheDirectory,
+                                uint64_t hash) {
+    std::error_code error;
+    std::filesystem::path full =
+        std::filesystem::weakly_canonical(source, error);
+    const std::string name = (error ? source : full).generic_string();
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), "-%016llx-%016llx.rgba",
+                  static_cast<unsigned long long>(
+                      hashBytes(std::as_bytes(std::span(name)))),
+                  static_cast<unsigned long long>(hash));
+    return cacheDirectory / (source.stem().string() + suffix);
+}
+
+size_t pixelBytes(int width, int height) {
+    return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+}
+
+// Points image at the pixels of a mapped cache entry, if it is one for hash.
+bool readEntry(const MappedFile &entry, uint64_t hash, Image &image) {
+    std::span<const std::byte> bytes = entry.bytes();
+    if (bytes.size() < sizeof(ImageHeader)) {
+        return false;
+    }
+    ImageHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (header.magic != IMAGE_MAGIC || header.version != IMAGE_VERSION ||
+        header.sourceHash != hash || header.width <= 0 ||
+        header.height <= 0 ||
+        bytes.size() - sizeof(header) !=
+            pixelBytes(header.width, header.height)) {
+        return false;
+    }
+    image.data = const_cast<std::byte *>(bytes.data() + sizeof(header));
+    image.width = header.width;
+    image.height = header.height;
+    image.mipmaps = 1;
+    image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    return true;
+}
+
+// Entries for older versions of the same source, which will never be read
+// again.
+void removeStaleEntries(const std::filesystem::path &path) {
+    const std::string name = path.filename().string();
+    const size_t prefix = name.size() - std::strlen("0123456789abcdef.rgba");
+    // Same source name and path hash, another content hash
+    std::error_code error;
+    for (const auto &entry :
+         std::filesystem::directory_iterator(path.parent_path(), error)) {
+        std::string other = entry.path().filename().string();
+        if (other != name && other.size() == name.size() &&
+            other.compare(0, prefix, name, 0, prefix) == 0 &&
+            entry.path().extension() == ".rgba") {
+            std::filesystem::remove(entry.path(), error);
+        }
+    }
+}
+
+// A failed write only costs the next start a decode. Entries are written
+// under a name of their own and renamed into place, so a thread or process
+// that has the entry mapped never sees it truncated under its feet, and two
+// writers of the same entry do not interleave.
+void writeEntry(const std::filesystem::path &path, uint64_t hash,
+                const Image &image) {
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    removeStaleEntries(path);
+    std::filesystem::path temporary = path;
+    temporary += "." + std::to_string(std::random_device()()) + ".tmp";
+    ImageHeader header{IMAGE_MAGIC, IMAGE_VERSION, hash, image.width,
+                       image.height};
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(static_cast<const char *>(image.data),
+              static_cast<std::streamsize>(
+                  pixelBytes(image.width, image.height)));
+    out.close();
+    if (out) {
+        std::filesystem::rename(temporary, path, error);
+    }
+    if (!out || error) {
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+} // namespace
+
+CachedImage::CachedImage(CachedImage &&other) noexcept {
+    *this = std::move(other);
+}
+
+CachedImage &CachedImage::operator=(CachedImage &&other) noexcept {
+    if (this != &other) {
+        if (!file.isOpen() && pixels.data != nullptr) {
+            UnloadImage(pixels);
+        }
+        pixels = std::exchange(other.pixels, Image{});
+        file = std::move(other.file);
+    }
+    return *this;
+}
+
+CachedImage::~CachedImage() {
+    if (!file.isOpen() && pixels.data != nullptr) {
+        UnloadImage(pixels);
+    }
+}
+
+CachedImage loadCachedImage(const std::filesystem::path &source,
+                            const std::filesystem::path &cacheDirectory) {
+    MappedFile encoded;
+    if (!encoded.open(source)) {
+        return {};
+    }
+    const uint64_t hash = hashBytes(encoded.bytes());
+    const std::filesystem::path path = entryPath(source, cacheDirectory, hash);
+
+    CachedImage cached;
+    if (cached.file.open(path) && readEntry(cached.file, hash, cached.pixels)) {
+        return cached;
+    }
+    cached.file.close();
+
+    Image image = LoadImageFromMemory(
+        source.extension().string().c_str(),
+        reinterpret_cast<const unsigned char *>(encoded.bytes().data()),
+        static_cast<int>(encoded.bytes().size()));
+    if (image.data == nullptr) {
+        return {};
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    ImageAlphaPremultiply(&image);
+    writeEntry(path, hash, image);
+    return CachedImage(image);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <raylib.h>
+#include "MappedFile.hpp"
+#include <filesystem>
+
+// A decoded image whose pixels are either owned, or read in place from a
+// memory-mapped cache entry.
+class CachedImage {
+
+  public:
+    CachedImage() = default;
+    // Takes ownership of an image from raylib.
+    explicit CachedImage(Image owned) : pixels(owned) {}
+    CachedImage(const CachedImage &) = delete;
+    CachedImage &operator=(const CachedImage &) = delete;
+    CachedImage(CachedImage &&other) noexcept;
+    CachedImage &operator=(CachedImage &&other) noexcept;
+    ~CachedImage();
+
+    // Premultiplied RGBA8. Data is null when the source could not be read.
+    const Image &image() const { return pixels; }
+
+  private:
+    friend CachedImage loadCachedImage(const std::filesystem::path &,
+                                       const std::filesystem::path &);
+
+    Image pixels{};
+    MappedFile file; // Open when pixels points into it
+};
+
+// Loads a PNG, or any other format raylib reads, as premultiplied RGBA8.
+// Decoded pixels are cached uncompressed in cacheDirectory under hashes of
+// the source file's path and contents, so later loads only map the cache
+// entry. Only touches the CPU side of raylib and may run on several threads
+// at once.
+CachedImage loadCachedImage(const std::filesystem::path &source,
+                            const std::filesystem::path &cacheDirectory);
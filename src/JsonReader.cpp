@@ -0,0 +1,289 @@
+#include "JsonReader.hpp"
+#include <charconv>
+
+JsonReader::JsonReader(std::istream &in) : in(in), buffer(BUFFER_SIZE) {}
+
+bool JsonReader::refill() {
+    if (pos < end) {
+        return true;
+    }
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    pos = 0;
+    end = static_cast<size_t>(in.gcount());
+    return end > 0;
+}
+
+void JsonReader::skipWhitespace() {
+    for (int c = peek(); c == ' ' || c == '\n' || c == '\r' || c == '\t';
+         c = peek()) {
+        ++pos;
+    }
+}
+
+JsonReader::Token JsonReader::fail() {
+    error = true;
+    return Token::Error;
+}
+
+JsonReader::Token JsonReader::next() {
+    if (error) {
+        return Token::Error;
+    }
+    skipWhitespace();
+    int c = peek();
+
+    if (!expectValue) {
+        if (c == -1 && containers.empty()) {
+            return Token::End;
+        }
+        if (c == ',' && !containers.empty()) {
+            ++pos;
+            skipWhitespace();
+            c = peek();
+            expectValue = true;
+            expectKey = containers.back() == '{';
+        } else if (c == '}' && !containers.empty() &&
+                   containers.back() == '{') {
+            ++pos;
+            containers.pop_back();
+            return Token::EndObject;
+        } else if (c == ']' && !containers.empty() &&
+                   containers.back() == '[') {
+            ++pos;
+            containers.pop_back();
+            return Token::EndArray;
+        } else {
+            return fail();
+        }
+    } else if (afterOpen && (c == '}' || c == ']')) {
+        // Empty container
+        if (c != (containers.back() == '{' ? '}' : ']')) {
+            return fail();
+        }
+        ++pos;
+        containers.pop_back();
+        afterOpen = false;
+        expectKey = false;
+        expectValue = false;
+        return c == '}' ? Token::EndObject : Token::EndArray;
+    }
+    afterOpen = false;
+
+    if (expectKey) {
+        if (c != '"' || !readString()) {
+            return fail();
+        }
+        skipWhitespace();
+        if (peek() != ':') {
+            return fail();
+        }
+        ++pos;
+        expectKey = false;
+        return Token::Key;
+    }
+
+    expectValue = false;
+    switch (c) {
+    case '{':
+    case '[':
+        ++pos;
+        containers.push_back(static_cast<char>(c));
+        expectKey = c == '{';
+        expectValue = true;
+        afterOpen = true;
+        return c == '{' ? Token::BeginObject : Token::BeginArray;
+    case '"':
+        return readString() ? Token::String : fail();
+    case 't':
+        return readLiteral("true") ? Token::True : fail();
+    case 'f':
+        return readLiteral("false") ? Token::False : fail();
+    case 'n':
+        return readLiteral("null") ? Token::Null : fail();
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return readNumber() ? Token::Number : fail();
+        }
+        return fail();
+    }
+}
+
+bool JsonReader::skip(Token first) {
+    if (first == Token::Key) {
+        return skip(next());
+    }
+    if (first != Token::BeginObject && first != Token::BeginArray) {
+        return first != Token::Error && first != Token::End;
+    }
+    int depth = 1;
+    while (depth > 0) {
+        switch (next()) {
+        case Token::BeginObject:
+        case Token::BeginArray:
+            ++depth;
+            break;
+        case Token::EndObject:
+        case Token::EndArray:
+            --depth;
+            break;
+        case Token::Error:
+        case Token::End:
+            return false;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+bool JsonReader::readLiteral(const char *literal) {
+    for (const char *p = literal; *p != '\0'; ++p) {
+        if (peek() != *p) {
+            return false;
+        }
+        ++pos;
+    }
+    return true;
+}
+
+bool JsonReader::readNumber() {
+    token.clear();
+    while (true) {
+        size_t start = pos;
+        while (pos < end) {
+            char c = buffer[pos];
+            if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+                  c == 'e' || c == 'E')) {
+                break;
+            }
+            ++pos;
+        }
+        token.append(buffer.data() + start, pos - start);
+        if (pos < end || !refill()) {
+            break;
+        }
+    }
+    double value;
+    auto result =
+        std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc() &&
+           result.ptr == token.data() + token.size();
+}
+
+static void appendUtf8(std::string &out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xc0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3f));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xe0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (codepoint & 0x3f));
+    } else {
+        out += static_cast<char>(0xf0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (codepoint & 0x3f));
+    }
+}
+
+bool JsonReader::readString() {
+    ++pos; // Opening quote
+    token.clear();
+
+    auto readHex = [this](uint32_t &value) {
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            int c = peek();
+            int digit = c >= '0' && c <= '9'   ? c - '0'
+                        : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                        : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                               : -1;
+            if (digit < 0) {
+                return false;
+            }
+            value = value * 16 + static_cast<uint32_t>(digit);
+            ++pos;
+        }
+        return true;
+    };
+
+    while (true) {
+        size_t start = pos;
+        while (pos < end && buffer[pos] != '"' && buffer[pos] != '\\' &&
+               static_cast<unsigned char>(buffer[pos]) >= 0x20) {
+            ++pos;
+        }
+        token.append(buffer.data() + start, pos - start);
+        if (pos == end && refill()) {
+            continue; // The string goes on in the next buffer
+        }
+
+        int c = peek();
+        if (c == '"') {
+            ++pos;
+            return true;
+        }
+        if (c != '\\') {
+            return false; // End of input or a raw control character
+        }
+        ++pos;
+        int escape = peek();
+        ++pos;
+        switch (escape) {
+        case '"':
+        case '\\':
+        case '/':
+            token += static_cast<char>(escape);
+            break;
+        case 'b':
+            token += '\b';
+            break;
+        case 'f':
+            token += '\f';
+            break;
+        case 'n':
+            token += '\n';
+            break;
+        case 'r':
+            token += '\r';
+            break;
+        case 't':
+            token += '\t';
+            break;
+        case 'u': {
+            uint32_t codepoint;
+            if (!readHex(codepoint)) {
+                return false;
+            }
+            if (codepoint >= 0xd800 && codepoint < 0xdc00) {
+                uint32_t low;
+                if (!readLiteral("\\u") || !readHex(low) || low < 0xdc00 ||
+                    low >= 0xe000) {
+                    return false;
+                }
+                codepoint = 0x10000 + ((codepoint - 0xd800) << 10) +
+                            (low - 0xdc00);
+            }
+            appendUtf8(token, codepoint);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+}
+
+double JsonReader::number() const {
+    double value = 0.0;
+    std::from_chars(token.data(), token.data() + token.size(), value);
+    return value;
+}
+
+bool JsonReader::uint32(uint32_t &value) const {
+    auto result =
+        std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc() &&
+           result.ptr == token.data() + token.size();
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Streaming pull parser. Reads the input through a fixed-size buffer and
+// hands out one token at a time, so memory use does not grow with the size
+// of the document. Only the current key, string or number is kept.
+class JsonReader {
+
+  public:
+    enum class Token {
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Key,    // Object key, text() holds the name
+        String, // text() holds the unescaped value
+        Number, // text() holds the literal, see number() and uint32()
+        True,
+        False,
+        Null,
+        End,   // End of input after a complete value
+        Error, // Malformed input; every later call returns Error as well
+    };
+
+    explicit JsonReader(std::istream &in);
+
+    Token next();
+
+    const std::string &text() const { return token; }
+    double number() const;
+    bool uint32(uint32_t &value) const;
+
+    // Skips the rest of a value whose first token was just returned, so
+    // skipping a BeginObject consumes everything up to the matching
+    // EndObject. Returns false on malformed input.
+    bool skip(Token first);
+
+    bool failed() const { return error; }
+
+  private:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    int peek() {
+        if (pos == end && !refill()) {
+            return -1;
+        }
+        return static_cast<unsigned char>(buffer[pos]);
+    }
+    bool refill();
+    void skipWhitespace();
+    bool readString();
+    bool readNumber();
+    bool readLiteral(const char *literal);
+    Token fail();
+
+    std::istream &in;
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t end = 0;
+
+    std::string token;
+    std::vector<char> containers; // '{' or '[' for every open container
+    bool expectKey = false;
+    bool expectValue = true; // False right after a value, until a ','
+    bool afterOpen = false;  // Right after '{' or '[', which may close at once
+    bool error = false;
+};
@@ -0,0 +1,282 @@
+#include "LevelBaker.hpp"
+#include "ColliderBaker.hpp"
+#include "TiledLoader.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+baked::Rect toRect(const tson::Object &object) {
+    tson::Vector2i pos = object.getPosition();
+    tson::Vector2i size = object.getSize();
+    return {static_cast<float>(pos.x), static_cast<float>(pos.y),
+            static_cast<float>(size.x), static_cast<float>(size.y)};
+}
+
+struct Writer {
+    std::vector<std::byte> bytes;
+
+    void align() { bytes.resize((bytes.size() + 7) & ~size_t{7}); }
+
+    template <typename T> baked::Section append(const std::vector<T> &items) {
+        align();
+        baked::Section section{bytes.size(), items.size()};
+        size_t size = items.size() * sizeof(T);
+        bytes.resize(bytes.size() + size);
+        if (size != 0) {
+            std::memcpy(bytes.data() + section.offset, items.data(), size);
+        }
+        return section;
+    }
+};
+
+// Moves a shape given relative to an unflipped tile into the flipped tile's
+// frame. Tiled applies the diagonal flip first.
+baked::Rect flipShape(baked::Rect shape, uint32_t cell, float width,
+                      float height) {
+    if (cell & baked::FLIPPED_DIAGONALLY) {
+        shape = {shape.y, shape.x, shape.height, shape.width};
+        std::swap(width, height);
+    }
+    if (cell & baked::FLIPPED_HORIZONTALLY) {
+        shape.x = width - shape.x - shape.width;
+    }
+    if (cell & baked::FLIPPED_VERTICALLY) {
+        shape.y = height - shape.y - shape.height;
+    }
+    return shape;
+}
+
+} // namespace
+
+baked::Rect tileSource(int local, int columns, int tileWidth, int tileHeight,
+                       int margin, int spacing) {
+    columns = std::max(columns, 1);
+    int column = local % columns;
+    int row = local / columns;
+    return {static_cast<float>(margin + column * (tileWidth + spacing)),
+            static_cast<float>(margin + row * (tileHeight + spacing)),
+            static_cast<float>(tileWidth), static_cast<float>(tileHeight)};
+}
+
+bool validGidRange(int firstGid, int tileCount) {
+    int64_t end = int64_t{firstGid} + tileCount;
+    return firstGid >= 1 && tileCount >= 0 &&
+           end <= int64_t{baked::gidOf(~0u)} + 1;
+}
+
+uint32_t tileCollision(std::string_view type, uint32_t shapeCount) {
+    if (type == "solid") {
+        return baked::COLLISION_SOLID;
+    }
+    if (type == "one-way") {
+        return baked::COLLISION_ONE_WAY;
+    }
+    if (type == "slope-rising") {
+        return baked::COLLISION_SLOPE_RISING;
+    }
+    if (type == "slope-falling") {
+        return baked::COLLISION_SLOPE_FALLING;
+    }
+    if (type == "none") {
+        return baked::COLLISION_NONE;
+    }
+    return shapeCount != 0 ? baked::COLLISION_SOLID : baked::COLLISION_NONE;
+}
+
+LevelData extractLevel(tson::Map &map) {
+    LevelData level;
+    level.width = map.getSize().x;
+    level.height = map.getSize().y;
+    level.tileWidth = map.getTileSize().x;
+    level.tileHeight = map.getTileSize().y;
+
+    uint32_t gidCount = 1;
+    for (tson::Tileset &tileset : map.getTilesets()) {
+        gidCount = std::max(gidCount, static_cast<uint32_t>(
+                                          tileset.getFirstgid() +
+                                          tileset.getTileCount()));
+    }
+    level.tiles.resize(gidCount, baked::Tile{});
+
+    for (tson::Tileset &tileset : map.getTilesets()) {
+        auto tilesetIndex = static_cast<uint32_t>(level.tilesets.size());
+        auto firstGid = static_cast<uint32_t>(tileset.getFirstgid());
+        level.tilesets.push_back({firstGid,
+                                  static_cast<uint32_t>(tileset.getTileCount()),
+                                  tileset.getImageSize().x,
+                                  tileset.getImageSize().y,
+                                  tileset.getImage().generic_string()});
+
+        tson::Vector2i tileSize = tileset.getTileSize();
+        for (int local = 0; local < tileset.getTileCount(); ++local) {
+            baked::Tile &tile = level.tiles[firstGid + local];
+            tile.tileset = tilesetIndex;
+            tile.source = tileSource(local, tileset.getColumns(), tileSize.x,
+                                     tileSize.y, tileset.getMargin(),
+                                     tileset.getSpacing());
+        }
+
+        for (tson::Tile &tsonTile : tileset.getTiles()) {
+            uint32_t gid = tsonTile.getGid();
+            if (gid >= level.tiles.size()) {
+                continue;
+            }
+            baked::Tile &tile = level.tiles[gid];
+            tile.firstShape = static_cast<uint32_t>(level.tileShapes.size());
+            for (const tson::Object &object :
+                 tsonTile.getObjectgroup().getObjects()) {
+                if (object.getObjectType() == tson::ObjectType::Rectangle) {
+                    level.tileShapes.push_back(toRect(object));
+                }
+            }
+            tile.shapeCount = static_cast<uint32_t>(level.tileShapes.size()) -
+                              tile.firstShape;
+            tile.collision = tileCollision(tsonTile.getType(), tile.shapeCount);
+        }
+    }
+
+    level.grid.assign(static_cast<size_t>(level.width) * level.height, 0);
+    if (tson::Layer *tileLayer = map.getLayer(TILE_LAYER_NAME)) {
+        const std::vector<uint32_t> &data = tileLayer->getData();
+        std::copy_n(data.begin(), std::min(data.size(), level.grid.size()),
+                    level.grid.begin());
+    }
+
+    if (tson::Layer *colliderLayer = map.getLayer(COLLIDER_LAYER_NAME)) {
+        for (const tson::Object &collider : colliderLayer->getObjects()) {
+            level.colliders.push_back(toRect(collider));
+        }
+    }
+
+    if (tson::Layer *objectLayer = map.getLayer(OBJECT_LAYER_NAME)) {
+        for (const tson::Object &object : objectLayer->getObjects()) {
+            level.objects.push_back(
+                {object.getName(), object.getType(), toRect(object)});
+        }
+    }
+
+    return level;
+}
+
+std::vector<baked::Rect> collectColliders(const LevelData &level) {
+    std::vector<baked::Rect> colliders = level.colliders;
+    size_t index = 0;
+    for (int y = 0; y < level.height; ++y) {
+        for (int x = 0; x < level.width; ++x, ++index) {
+            uint32_t cell = level.grid[index];
+            uint32_t gid = baked::gidOf(cell);
+            if (gid == 0 || gid >= level.tiles.size()) {
+                continue;
+            }
+            const baked::Tile &tile = level.tiles[gid];
+            const float left = static_cast<float>(x * level.tileWidth);
+            // What CollisionGrid treats as solid: solid tiles, and slopes
+            // turned upside down. Upright slopes and one-way tiles only stop
+            // characters from above and are left out.
+            const bool slope =
+                tile.collision == baked::COLLISION_SLOPE_RISING ||
+                tile.collision == baked::COLLISION_SLOPE_FALLING;
+            const bool upsideDown =
+                (cell & (baked::FLIPPED_VERTICALLY |
+                         baked::FLIPPED_DIAGONALLY)) != 0;
+            if (tile.collision != baked::COLLISION_SOLID &&
+                !(slope && upsideDown)) {
+                continue;
+            }
+            if (slope || tile.shapeCount == 0) {
+                colliders.push_back(
+                    {left, static_cast<float>(y * level.tileHeight),
+                     static_cast<float>(level.tileWidth),
+                     static_cast<float>(level.tileHeight)});
+                continue;
+            }
+            // Tiles taller than the grid are anchored to the bottom of their
+            // cell, like Tiled draws them.
+            const float top = static_cast<float>((y + 1) * level.tileHeight) -
+                              tile.source.height;
+            for (uint32_t i = 0; i < tile.shapeCount; ++i) {
+                baked::Rect shape =
+                    flipShape(level.tileShapes[tile.firstShape + i], cell,
+                              tile.source.width, tile.source.height);
+                colliders.push_back({left + shape.x, top + shape.y,
+                                     shape.width, shape.height});
+            }
+        }
+    }
+    return colliders;
+}
+
+std::vector<std::byte> writeBakedLevel(const LevelData &level) {
+    Writer writer;
+    writer.bytes.resize(sizeof(baked::Header));
+
+    std::vector<char> strings;
+    auto intern = [&strings](const std::string &text) {
+        baked::StringRef ref{static_cast<uint32_t>(strings.size()),
+                             static_cast<uint32_t>(text.size())};
+        strings.insert(strings.end(), text.begin(), text.end());
+        return ref;
+    };
+
+    std::vector<baked::Tileset> tilesets;
+    for (const LevelData::Tileset &tileset : level.tilesets) {
+        tilesets.push_back({tileset.firstGid, tileset.tileCount,
+                            tileset.imageWidth, tileset.imageHeight,
+                            intern(tileset.image)});
+    }
+
+    std::vector<baked::Object> objects;
+    for (const LevelData::Object &object : level.objects) {
+        objects.push_back(
+            {intern(object.name), intern(object.type), object.bounds});
+    }
+
+    baked::Header header{};
+    header.magic = baked::MAGIC;
+    header.version = baked::VERSION;
+    header.width = level.width;
+    header.height = level.height;
+    header.tileWidth = level.tileWidth;
+    header.tileHeight = level.tileHeight;
+    header.tilesets = writer.append(tilesets);
+    header.tiles = writer.append(level.tiles);
+    header.tileShapes = writer.append(level.tileShapes);
+    header.grid = writer.append(level.grid);
+    MergedColliders colliders = mergeColliders(collectColliders(level));
+    header.colliders = writer.append(colliders.boxes);
+    header.colliderPoints = writer.append(colliders.points);
+    header.colliderLoops = writer.append(colliders.loops);
+    header.objects = writer.append(objects);
+    header.strings = writer.append(strings);
+
+    std::memcpy(writer.bytes.data(), &header, sizeof(header));
+    return writer.bytes;
+}
+
+std::vector<std::byte> bakeLevel(tson::Tileson &tileson,
+                                 const std::filesystem::path &json) {
+    LevelData level;
+    if (loadTiledLevel(json, level, *tileson.decompressors())) {
+        return writeBakedLevel(level);
+    }
+    // Features the streaming loader does not handle
+    std::unique_ptr<tson::Map> map = tileson.parse(json);
+    if (map->getStatus() != tson::ParseStatus::OK) {
+        return {};
+    }
+    for (tson::Tileset &tileset : map->getTilesets()) {
+        if (!validGidRange(tileset.getFirstgid(), tileset.getTileCount())) {
+            return {};
+        }
+    }
+    // tileson leaves the ids empty when the layer data fails to decode:
+    // damaged, or compressed in a way this build has no library for.
+    tson::Layer *tileLayer = map->getLayer(TILE_LAYER_NAME);
+    if (tileLayer != nullptr && !tileLayer->getBase64Data().empty() &&
+        tileLayer->getData().empty()) {
+        return {};
+    }
+    return writeBakedLevel(extractLevel(*map));
+}
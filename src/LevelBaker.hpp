@@ -0,0 +1,66 @@
+#pragma once
+#include "BakedLevel.hpp"
+#include "tileson.hpp"
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr const char *TILE_LAYER_NAME = "Tile Layer 1";
+constexpr const char *OBJECT_LAYER_NAME = "Object Layer 1";
+constexpr const char *COLLIDER_LAYER_NAME = "collider layer";
+
+// Everything the game needs from a level, in a form that is independent of
+// both Tiled's JSON and the baked file layout.
+struct LevelData {
+    struct Tileset {
+        uint32_t firstGid;
+        uint32_t tileCount;
+        int imageWidth;
+        int imageHeight;
+        std::string image;
+    };
+
+    struct Object {
+        std::string name;
+        std::string type;
+        baked::Rect bounds;
+    };
+
+    int width = 0;
+    int height = 0;
+    int tileWidth = 0;
+    int tileHeight = 0;
+
+    std::vector<Tileset> tilesets;
+    std::vector<baked::Tile> tiles; // Indexed by gid, entry 0 is unused
+    std::vector<baked::Rect> tileShapes;
+    std::vector<uint32_t> grid;
+    std::vector<baked::Rect> colliders; // Hand-drawn, from the collider layer
+    std::vector<Object> objects;
+};
+
+// Where tile local sits in its tileset image.
+baked::Rect tileSource(int local, int columns, int tileWidth, int tileHeight,
+                       int margin, int spacing);
+
+// Whether a tileset's gids, firstGid up to firstGid + tileCount, are all
+// valid gids: at least 1 and clear of the flip flags.
+bool validGidRange(int firstGid, int tileCount);
+
+// The COLLISION_* kind of a tile, from its type in Tiled.
+uint32_t tileCollision(std::string_view type, uint32_t shapeCount);
+
+LevelData extractLevel(tson::Map &map);
+
+// The collision shapes of every solid tile placed in the grid, in pixels, a
+// full cell for solid tiles without shapes and upside-down slopes, plus the
+// hand-drawn colliders. Linear in the number of cells.
+std::vector<baked::Rect> collectColliders(const LevelData &level);
+
+std::vector<std::byte> writeBakedLevel(const LevelData &level);
+
+// Parses a Tiled JSON level and bakes it in memory. Uses loadTiledLevel()
+// and falls back to tileson for maps it does not handle.
+std::vector<std::byte> bakeLevel(tson::Tileson &tileson,
+                                 const std::filesystem::path &json);
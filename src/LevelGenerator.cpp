@@ -0,0 +1,448 @@
+#include "LevelGenerator.hpp"
+#include <algorithm>
+#include <charconv>
+#include <string>
+
+namespace {
+
+constexpr int TILES_PER_TILESET = 16;
+constexpr int TILESET_COLUMNS = 4;
+constexpr int MEAN_RUN_LENGTH = 8;
+
+// SplitMix64, small and fast enough to fill 10000x10000 maps.
+struct Random {
+    uint64_t state;
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15u);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, bound).
+    int below(int bound) {
+        return bound <= 0 ? 0 : static_cast<int>(next() % bound);
+    }
+
+    float unit() { return static_cast<float>(next() >> 40) / (1 << 24); }
+
+    // Uniform in [1, 2 * mean - 1], so the average is mean.
+    int length(float mean) {
+        int upper = std::max(1, static_cast<int>(2.0f * mean + 0.5f) - 1);
+        return 1 + below(upper);
+    }
+};
+
+void fillTerrain(LevelData &level, const GeneratorOptions &options,
+                 Random &random) {
+    const float density = std::clamp(options.density, 0.0f, 1.0f);
+    if (density <= 0.0f) {
+        return;
+    }
+    const float meanGap = MEAN_RUN_LENGTH * (1.0f - density) / density;
+    const int tilesets = static_cast<int>(level.tilesets.size());
+
+    for (int y = 0; y < level.height; ++y) {
+        uint32_t *row =
+            level.grid.data() + static_cast<size_t>(y) * level.width;
+        int x = random.unit() < density ? 0 : random.length(meanGap);
+        while (x < level.width) {
+            const LevelData::Tileset &tileset =
+                level.tilesets[random.below(tilesets)];
+            int end = std::min(level.width,
+                               x + random.length(MEAN_RUN_LENGTH));
+            for (; x < end; ++x) {
+                // Mostly solid ground, with the odd decoration mixed in.
+                int local = random.below(8) == 0
+                                ? 1 + random.below(TILES_PER_TILESET - 1)
+                                : 0;
+                row[x] = tileset.firstGid + local;
+            }
+            if (density < 1.0f) {
+                x += random.length(meanGap);
+            }
+        }
+    }
+}
+
+void addColliders(LevelData &level, const GeneratorOptions &options,
+                  Random &random) {
+    const float tileWidth = static_cast<float>(level.tileWidth);
+    const float tileHeight = static_cast<float>(level.tileHeight);
+    for (int i = 0; i < options.colliders; ++i) {
+        int width = 1 + random.below(8);
+        int height = 1 + random.below(2);
+        int x = random.below(std::max(1, level.width - width + 1));
+        int y = random.below(std::max(1, level.height - height + 1));
+        level.colliders.push_back({x * tileWidth, y * tileHeight,
+                                   width * tileWidth, height * tileHeight});
+    }
+}
+
+// The centre of a cell without a tile, so whatever spawns there starts out
+// free; a few tries, then wherever the last one landed.
+baked::Rect emptyCell(const LevelData &level, Random &random) {
+    int x = 0;
+    int y = 0;
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        x = random.below(level.width);
+        y = random.below(level.height);
+        if (level.grid[static_cast<size_t>(y) * level.width + x] == 0) {
+            break;
+        }
+    }
+    return {(x + 0.5f) * level.tileWidth, (y + 0.5f) * level.tileHeight,
+            0.0f, 0.0f};
+}
+
+// The player near the top left corner, enemy spawns and props anywhere
+// there is room.
+void addObjects(LevelData &level, const GeneratorOptions &options,
+                Random &random) {
+    for (int i = 0; i < options.objects; ++i) {
+        if (i == 0) {
+            level.objects.push_back(
+                {"player",
+                 "",
+                 {2.0f * level.tileWidth, 2.0f * level.tileHeight, 0.0f,
+                  0.0f}});
+        } else {
+            level.objects.push_back(
+                {"spawn", "enemy", emptyCell(level, random)});
+        }
+    }
+    for (int i = 0; i < options.props; ++i) {
+        level.objects.push_back({"prop", "prop", emptyCell(level, random)});
+    }
+}
+
+// Buffers output and formats numbers with to_chars; the tile data of a large
+// map is hundreds of megabytes.
+class JsonWriter {
+
+  public:
+    explicit JsonWriter(std::ostream &out) : out(out) {
+        buffer.reserve(FLUSH_SIZE + 256);
+    }
+    ~JsonWriter() { flush(); }
+
+    JsonWriter &operator<<(const char *text) {
+        buffer += text;
+        return maybeFlush();
+    }
+    JsonWriter &operator<<(const std::string &text) {
+        buffer += '"';
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                buffer += '\\';
+            }
+            buffer += c;
+        }
+        buffer += '"';
+        return maybeFlush();
+    }
+    template <typename T> JsonWriter &number(T value) {
+        char digits[32];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, result.ptr);
+        return maybeFlush();
+    }
+
+    JsonWriter &write(const char *data, size_t size) {
+        buffer.append(data, size);
+        return maybeFlush();
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+  private:
+    static constexpr size_t FLUSH_SIZE = 1 << 20;
+
+    JsonWriter &maybeFlush() {
+        if (buffer.size() >= FLUSH_SIZE) {
+            flush();
+        }
+        return *this;
+    }
+
+    std::ostream &out;
+    std::string buffer;
+};
+
+void writeObject(JsonWriter &json, int id, const std::string &name,
+                 const std::string &type, const baked::Rect &bounds,
+                 bool point) {
+    json << "{\"id\":";
+    json.number(id) << ",\"name\":" << name << ",\"type\":" << type;
+    json << ",\"x\":";
+    json.number(bounds.x) << ",\"y\":";
+    json.number(bounds.y) << ",\"width\":";
+    json.number(bounds.width) << ",\"height\":";
+    json.number(bounds.height) << ",\"rotation\":0,\"visible\":true";
+    json << (point ? ",\"point\":true}" : "}");
+}
+
+void writeObjectLayer(JsonWriter &json, int id, const char *name,
+                      int &nextObjectId,
+                      const std::vector<LevelData::Object> &objects) {
+    json << "{\"id\":";
+    json.number(id) << ",\"name\":\"" << name
+                    << "\",\"type\":\"objectgroup\",\"draworder\":"
+                       "\"topdown\",\"opacity\":1,\"visible\":true,"
+                       "\"x\":0,\"y\":0,\"objects\":[";
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const LevelData::Object &object = objects[i];
+        json << (i == 0 ? "" : ",");
+        writeObject(json, nextObjectId++, object.name, object.type,
+                    object.bounds,
+                    object.bounds.width == 0.0f &&
+                        object.bounds.height == 0.0f);
+    }
+    json << "]}";
+}
+
+// Tile ids in little-endian byte order, as Tiled stores them before
+// compressing and encoding.
+std::vector<uint8_t> tileBytes(const std::vector<uint32_t> &grid) {
+    std::vector<uint8_t> bytes(grid.size() * 4);
+    for (size_t i = 0; i < grid.size(); ++i) {
+        for (int b = 0; b < 4; ++b) {
+            bytes[i * 4 + b] = static_cast<uint8_t>(grid[i] >> (8 * b));
+        }
+    }
+    return bytes;
+}
+
+// Empty if this build lacks the library.
+std::vector<uint8_t>
+compress([[maybe_unused]] const std::vector<uint8_t> &bytes,
+         [[maybe_unused]] TileCompression compression) {
+    std::vector<uint8_t> out;
+#ifdef TSON_USE_ZLIB
+    if (compression == TileCompression::Zlib ||
+        compression == TileCompression::Gzip) {
+        z_stream stream{};
+        int windowBits = compression == TileCompression::Gzip ? 15 + 16 : 15;
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            return out;
+        }
+        out.resize(deflateBound(&stream, bytes.size()));
+        stream.next_in = const_cast<Bytef *>(bytes.data());
+        stream.avail_in = static_cast<uInt>(bytes.size());
+        stream.next_out = out.data();
+        stream.avail_out = static_cast<uInt>(out.size());
+        int status = deflate(&stream, Z_FINISH);
+        out.resize(status == Z_STREAM_END ? stream.total_out : 0);
+        deflateEnd(&stream);
+    }
+#endif
+#ifdef TSON_USE_ZSTD
+    if (compression == TileCompression::Zstd) {
+        ZSTD_CCtx *context = ZSTD_createCCtx();
+        if (context == nullptr) {
+            return out;
+        }
+        // Like the Adler-32 of zlib and the CRC of gzip, so a damaged layer
+        // fails to decompress instead of loading wrong tiles.
+        ZSTD_CCtx_setParameter(context, ZSTD_c_checksumFlag, 1);
+        out.resize(ZSTD_compressBound(bytes.size()));
+        size_t size = ZSTD_compress2(context, out.data(), out.size(),
+                                     bytes.data(), bytes.size());
+        out.resize(ZSTD_isError(size) ? 0 : size);
+        ZSTD_freeCCtx(context);
+    }
+#endif
+    return out;
+}
+
+void writeBase64(JsonWriter &json, const std::vector<uint8_t> &bytes) {
+    static constexpr char ALPHABET[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const size_t size = bytes.size();
+    char chunk[4096];
+    size_t used = 0;
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t value = static_cast<uint32_t>(bytes[i]) << 16;
+        value |= i + 1 < size ? static_cast<uint32_t>(bytes[i + 1]) << 8 : 0;
+        value |= i + 2 < size ? bytes[i + 2] : 0;
+        chunk[used++] = ALPHABET[(value >> 18) & 63];
+        chunk[used++] = ALPHABET[(value >> 12) & 63];
+        chunk[used++] = i + 1 < size ? ALPHABET[(value >> 6) & 63] : '=';
+        chunk[used++] = i + 2 < size ? ALPHABET[value & 63] : '=';
+        if (used == sizeof(chunk)) {
+            json.write(chunk, used);
+            used = 0;
+        }
+    }
+    json.write(chunk, used);
+}
+
+constexpr const char *compressionName(TileCompression compression) {
+    switch (compression) {
+    case TileCompression::Zlib:
+        return "zlib";
+    case TileCompression::Gzip:
+        return "gzip";
+    case TileCompression::Zstd:
+        return "zstd";
+    default:
+        return "";
+    }
+}
+
+} // namespace
+
+bool compressionSupported(TileCompression compression) {
+    switch (compression) {
+    case TileCompression::None:
+        return true;
+#ifdef TSON_USE_ZLIB
+    case TileCompression::Zlib:
+    case TileCompression::Gzip:
+        return true;
+#endif
+#ifdef TSON_USE_ZSTD
+    case TileCompression::Zstd:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+LevelData generateLevel(const GeneratorOptions &options) {
+    LevelData level;
+    level.width = std::max(1, options.width);
+    level.height = std::max(1, options.height);
+    level.tileWidth = 16;
+    level.tileHeight = 16;
+
+    const int tilesetCount = std::max(1, options.tilesets);
+    level.tiles.resize(1 + tilesetCount * TILES_PER_TILESET, baked::Tile{});
+    for (int i = 0; i < tilesetCount; ++i) {
+        auto firstGid = static_cast<uint32_t>(1 + i * TILES_PER_TILESET);
+        level.tilesets.push_back(
+            {firstGid, TILES_PER_TILESET, 64, 64, "tileset.png"});
+        for (int local = 0; local < TILES_PER_TILESET; ++local) {
+            baked::Tile &tile = level.tiles[firstGid + local];
+            tile.tileset = static_cast<uint32_t>(i);
+            tile.source = {static_cast<float>(local % TILESET_COLUMNS * 16),
+                           static_cast<float>(local / TILESET_COLUMNS * 16),
+                           16.0f, 16.0f};
+        }
+        baked::Tile &solid = level.tiles[firstGid];
+        solid.firstShape = static_cast<uint32_t>(level.tileShapes.size());
+        solid.shapeCount = 1;
+        solid.collision = baked::COLLISION_SOLID;
+        level.tileShapes.push_back({0.0f, 0.0f, 16.0f, 16.0f});
+        // Shape ranges like extractLevel() would produce, so baking the JSON
+        // output gives the same bytes as baking the level directly.
+        for (int local = 1; local < TILES_PER_TILESET; ++local) {
+            level.tiles[firstGid + local].firstShape =
+                static_cast<uint32_t>(level.tileShapes.size());
+        }
+    }
+
+    Random random{options.seed};
+    level.grid.assign(static_cast<size_t>(level.width) * level.height, 0);
+    fillTerrain(level, options, random);
+    addColliders(level, options, random);
+    addObjects(level, options, random);
+    return level;
+}
+
+void writeTiledJson(const LevelData &level, std::ostream &out,
+                    TileEncoding encoding, TileCompression compression) {
+    JsonWriter json(out);
+    int nextObjectId = 1;
+
+    json << "{\"type\":\"map\",\"version\":\"1.6\",\"tiledversion\":"
+            "\"1.7.2\",\"orientation\":\"orthogonal\",\"renderorder\":"
+            "\"right-down\",\"infinite\":false,\"compressionlevel\":-1,"
+            "\"nextlayerid\":4,\"width\":";
+    json.number(level.width) << ",\"height\":";
+    json.number(level.height) << ",\"tilewidth\":";
+    json.number(level.tileWidth) << ",\"tileheight\":";
+    json.number(level.tileHeight) << ",\"tilesets\":[";
+
+    for (size_t i = 0; i < level.tilesets.size(); ++i) {
+        const LevelData::Tileset &tileset = level.tilesets[i];
+        const baked::Tile &first = level.tiles[tileset.firstGid];
+        const int columns = std::max(
+            1, tileset.imageWidth / static_cast<int>(first.source.width));
+        json << (i == 0 ? "{" : ",{") << "\"firstgid\":";
+        json.number(tileset.firstGid) << ",\"name\":"
+                                      << ("tileset" + std::to_string(i))
+                                      << ",\"image\":" << tileset.image
+                                      << ",\"imagewidth\":";
+        json.number(tileset.imageWidth) << ",\"imageheight\":";
+        json.number(tileset.imageHeight) << ",\"tilewidth\":";
+        json.number(static_cast<int>(first.source.width))
+            << ",\"tileheight\":";
+        json.number(static_cast<int>(first.source.height)) << ",\"columns\":";
+        json.number(columns) << ",\"tilecount\":";
+        json.number(tileset.tileCount)
+            << ",\"margin\":0,\"spacing\":0,\"tiles\":[";
+
+        bool firstTile = true;
+        for (uint32_t local = 0; local < tileset.tileCount; ++local) {
+            const baked::Tile &tile = level.tiles[tileset.firstGid + local];
+            if (tile.shapeCount == 0) {
+                continue;
+            }
+            json << (firstTile ? "{" : ",{") << "\"id\":";
+            json.number(local)
+                << ",\"objectgroup\":{\"type\":\"objectgroup\",\"name\":\"\","
+                   "\"draworder\":\"index\",\"objects\":[";
+            for (uint32_t s = 0; s < tile.shapeCount; ++s) {
+                json << (s == 0 ? "" : ",");
+                writeObject(json, static_cast<int>(s + 1), "", "",
+                            level.tileShapes[tile.firstShape + s], false);
+            }
+            json << "]}}";
+            firstTile = false;
+        }
+        json << "]}";
+    }
+
+    json << "],\"layers\":[{\"id\":1,\"name\":\"" << TILE_LAYER_NAME
+         << "\",\"type\":\"tilelayer\",\"opacity\":1,\"visible\":true,"
+            "\"x\":0,\"y\":0,\"width\":";
+    json.number(level.width) << ",\"height\":";
+    json.number(level.height);
+    if (compression != TileCompression::None) {
+        json << ",\"encoding\":\"base64\",\"compression\":\""
+             << compressionName(compression) << "\",\"data\":\"";
+        writeBase64(json, compress(tileBytes(level.grid), compression));
+        json << "\"},";
+    } else if (encoding == TileEncoding::Base64) {
+        json << ",\"encoding\":\"base64\",\"data\":\"";
+        writeBase64(json, tileBytes(level.grid));
+        json << "\"},";
+    } else {
+        json << ",\"data\":[";
+        for (size_t i = 0; i < level.grid.size(); ++i) {
+            if (i != 0) {
+                json << ",";
+            }
+            json.number(level.grid[i]);
+        }
+        json << "]},";
+    }
+
+    writeObjectLayer(json, 2, OBJECT_LAYER_NAME, nextObjectId, level.objects);
+    std::vector<LevelData::Object> colliders;
+    for (const baked::Rect &collider : level.colliders) {
+        colliders.push_back({"", "", collider});
+    }
+    json << ",";
+    writeObjectLayer(json, 3, COLLIDER_LAYER_NAME, nextObjectId, colliders);
+
+    json << "],\"nextobjectid\":";
+    json.number(nextObjectId) << "}";
+}
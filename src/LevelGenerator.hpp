@@ -0,0 +1,35 @@
+#pragma once
+#include "LevelBaker.hpp"
+#include <cstdint>
+#include <ostream>
+
+// Shape of a generated level. The same options and seed always produce the
+// same level.
+struct GeneratorOptions {
+    int width = 100;       // In tiles
+    int height = 100;      // In tiles
+    float density = 0.2f;  // Fraction of cells holding a tile
+    int colliders = 0;     // Hand-drawn colliders on top of the tiles
+    int objects = 1;       // The player, then enemy characters
+    int props = 0;         // Box2D crates, each in an empty cell
+    int tilesets = 1;      // Copies of res/tileset.png, 16 tiles each
+    uint64_t seed = 1;
+};
+
+// Random terrain for scaling tests: rows of solid tile runs whose total
+// matches the requested density. The first tile of every tileset is solid,
+// the others are decoration without collision shapes.
+LevelData generateLevel(const GeneratorOptions &options);
+
+// How the tile layer data is stored, see Tiled's "encoding" and
+// "compression" layer properties. Compression implies base64.
+enum class TileEncoding { Csv, Base64 };
+enum class TileCompression { None, Zlib, Gzip, Zstd };
+
+// Whether this build links the library the compression needs.
+bool compressionSupported(TileCompression compression);
+
+// Writes the level as a Tiled map that extractLevel() reads back unchanged.
+void writeTiledJson(const LevelData &level, std::ostream &out,
+                    TileEncoding encoding = TileEncoding::Csv,
+                    TileCompression compression = TileCompression::None);
@@ -0,0 +1,49 @@
+#include "LevelLoader.hpp"
+#include "LevelView.hpp"
+#include <chrono>
+#include <exception>
+
+LevelLoader::LevelLoader(const std::filesystem::path &resources) {
+    result = std::async(std::launch::async, [this, resources] {
+        LoadedLevel loaded;
+        // Nothing may escape into the future: the destructor and take()
+        // must not throw.
+        try {
+            load(loaded, resources);
+        } catch (const std::exception &e) {
+            TraceLog(LOG_ERROR, "Loading the level failed: %s", e.what());
+            loaded = {};
+        } catch (...) {
+            TraceLog(LOG_ERROR, "Loading the level failed");
+            loaded = {};
+        }
+        status.report(loaded.isOpen() ? "Done" : "Failed to load the level",
+                      1.0f);
+        return loaded;
+    });
+}
+
+void LevelLoader::load(LoadedLevel &loaded,
+                       const std::filesystem::path &resources) {
+    loaded.map = std::make_unique<MapLevel>(tileson, resources, &status);
+    if (!loaded.map->level.isOpen()) {
+        return;
+    }
+    status.report("Decoding tilesets", 0.95f);
+    loaded.atlas = TileAtlas(loaded.map->level);
+    loaded.pages = buildAtlasPages(
+        loaded.atlas, loadTilesetImages(loaded.map->level, resources));
+}
+
+LevelLoader::~LevelLoader() {
+    if (result.valid()) {
+        result.wait();
+    }
+}
+
+bool LevelLoader::ready() const {
+    return result.valid() && result.wait_for(std::chrono::seconds(0)) ==
+                                 std::future_status::ready;
+}
+
+LoadedLevel LevelLoader::take() { return result.get(); }
@@ -0,0 +1,47 @@
+#pragma once
+#include <raylib.h>
+#include "ImageCache.hpp"
+#include "MapLevel.hpp"
+#include "TileAtlas.hpp"
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <vector>
+
+// Everything a level needs before its first frame, except the GPU upload.
+struct LoadedLevel {
+    std::unique_ptr<MapLevel> map;
+    TileAtlas atlas;
+    std::vector<CachedImage> pages; // See buildAtlasPages()
+
+    // False if loading failed; the log says why.
+    bool isOpen() const { return map != nullptr && map->level.isOpen(); }
+};
+
+// Loads a level on a worker thread: parsing or reading the baked level,
+// collider baking, physics setup, image decoding and atlas packing. The
+// thread that owns the GL context keeps drawing meanwhile and creates the
+// LevelView once ready() returns true.
+class LevelLoader {
+
+  public:
+    explicit LevelLoader(const std::filesystem::path &resources);
+    LevelLoader(const LevelLoader &) = delete;
+    LevelLoader &operator=(const LevelLoader &) = delete;
+    // Waits for the worker if the level was never taken.
+    ~LevelLoader();
+
+    // True once the worker has finished, whether loading worked or not.
+    bool ready() const;
+    // Only once, after ready(). Never throws; check isOpen() on the result.
+    LoadedLevel take();
+
+    const LoadProgress &progress() const { return status; }
+
+  private:
+    void load(LoadedLevel &loaded, const std::filesystem::path &resources);
+
+    LoadProgress status;
+    tson::Tileson tileson; // Only used by the worker
+    std::future<LoadedLevel> result;
+};
@@ -0,0 +1,214 @@
+#include "LevelView.hpp"
+#include "ParallelFor.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+// Repeats the outermost pixels of the image at place into the padding
+// around it, as far as the page reaches.
+void extrudeEdges(uint32_t *pixels, int pageWidth, int pageHeight,
+                  const TileAtlas::Placement &place) {
+    auto at = [&](int x, int y) -> uint32_t & {
+        return pixels[static_cast<size_t>(y) * pageWidth + x];
+    };
+    const int left = std::max(0, place.x - ATLAS_PADDING);
+    const int right =
+        std::min(pageWidth, place.x + place.width + ATLAS_PADDING);
+    for (int y = place.y; y < place.y + place.height; ++y) {
+        for (int x = left; x < place.x; ++x) {
+            at(x, y) = at(place.x, y);
+        }
+        for (int x = place.x + place.width; x < right; ++x) {
+            at(x, y) = at(place.x + place.width - 1, y);
+        }
+    }
+    const size_t rowBytes = static_cast<size_t>(right - left) * 4;
+    for (int y = std::max(0, place.y - ATLAS_PADDING); y < place.y; ++y) {
+        std::memcpy(&at(left, y), &at(left, place.y), rowBytes);
+    }
+    const int bottom = place.y + place.height;
+    for (int y = bottom;
+         y < std::min(pageHeight, bottom + ATLAS_PADDING); ++y) {
+        std::memcpy(&at(left, y), &at(left, bottom - 1), rowBytes);
+    }
+}
+
+} // namespace
+
+PlayerInput pollInput() {
+    return {IsKeyDown(KEY_A), IsKeyDown(KEY_D), IsKeyPressed(KEY_SPACE),
+            IsKeyDown(KEY_S)};
+}
+
+std::vector<CachedImage>
+loadTilesetImages(const BakedLevel &level,
+                  const std::filesystem::path &resources) {
+    std::vector<std::filesystem::path> paths;
+    for (const baked::Tileset &tileset : level.tilesets()) {
+        paths.push_back(resources / level.string(tileset.image));
+    }
+
+    // Tilesets often share an image file; decode each file once. TileAtlas
+    // places them together.
+    std::vector<size_t> source(paths.size());
+    std::vector<size_t> unique;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        source[i] = static_cast<size_t>(
+            std::find(paths.begin(), paths.begin() + i, paths[i]) -
+            paths.begin());
+        if (source[i] == i) {
+            unique.push_back(i);
+        }
+    }
+
+    // PNG decoding dominates on a cold cache and does not touch GL, so the
+    // files are loaded in parallel.
+    const std::filesystem::path cache = resources / ".cache";
+    std::vector<CachedImage> images(paths.size());
+    parallelFor(unique.size(), [&](size_t i) {
+        images[unique[i]] = loadCachedImage(paths[unique[i]], cache);
+    });
+    return images;
+}
+
+std::vector<CachedImage> buildAtlasPages(const TileAtlas &atlas,
+                                         std::vector<CachedImage> images) {
+    std::span<const TileAtlas::Placement> placements = atlas.placements();
+    std::span<const TileAtlas::Page> pages = atlas.pages();
+    std::vector<std::vector<size_t>> contents(pages.size());
+    for (size_t i = 0; i < images.size() && i < placements.size(); ++i) {
+        if (images[i].image().data != nullptr &&
+            placements[i].page < pages.size()) {
+            contents[placements[i].page].push_back(i);
+        }
+    }
+
+    std::vector<CachedImage> result(pages.size());
+    for (size_t page = 0; page < pages.size(); ++page) {
+        const TileAtlas::Page &size = pages[page];
+        // A page that is exactly one image, the common single tileset case,
+        // keeps it as is, possibly still mapped from the image cache.
+        if (contents[page].size() == 1) {
+            const Image &only = images[contents[page][0]].image();
+            if (only.width == size.width && only.height == size.height) {
+                result[page] = std::move(images[contents[page][0]]);
+                continue;
+            }
+        }
+
+        // Images from loadCachedImage() are RGBA8, so rows copy directly.
+        Image pixels = GenImageColor(size.width, size.height, BLANK);
+        uint32_t *out = static_cast<uint32_t *>(pixels.data);
+        for (size_t i : contents[page]) {
+            const Image &image = images[i].image();
+            const TileAtlas::Placement &place = placements[i];
+            const int width = std::min(image.width, place.width);
+            const int height = std::min(image.height, place.height);
+            for (int y = 0; y < height; ++y) {
+                std::memcpy(out + static_cast<size_t>(place.y + y) *
+                                      size.width +
+                                place.x,
+                            static_cast<const unsigned char *>(image.data) +
+                                static_cast<size_t>(y) * image.width * 4,
+                            static_cast<size_t>(width) * 4);
+            }
+            if (width > 0 && height > 0) {
+                extrudeEdges(out, size.width, size.height,
+                             {place.page, place.x, place.y, width, height});
+            }
+        }
+        result[page] = CachedImage(pixels);
+    }
+    return result;
+}
+
+void drawLoadingScreen(const LoadProgress &progress) {
+    const float width = static_cast<float>(GetScreenWidth());
+    const float height = static_cast<float>(GetScreenHeight());
+    const Rectangle bar = {width * 0.2f, height * 0.5f, width * 0.6f, 16.0f};
+    DrawText(progress.stage, static_cast<int>(bar.x),
+             static_cast<int>(bar.y) - 28, 20, RAYWHITE);
+    DrawRectangleRec({bar.x, bar.y, bar.width * progress.fraction, bar.height},
+                     RAYWHITE);
+    DrawRectangleLinesEx(bar, 2.0f, RAYWHITE);
+}
+
+LevelView::LevelView(const MapLevel &map, const TileAtlas &atlas,
+                     std::vector<CachedImage> pages)
+    : map(map), tileChunks(map.level, atlas) {
+    // Upload everything in one go, then free the CPU copies.
+    textures.reserve(pages.size());
+    for (const CachedImage &page : pages) {
+        textures.push_back(LoadTextureFromImage(page.image()));
+    }
+    pages.clear();
+
+    camera.target = {100, 20};
+    camera.offset = {GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f};
+    camera.rotation = 0.0f;
+    camera.zoom = 3.0f;
+}
+
+LevelView::~LevelView() {
+    for (Texture2D &texture : textures) {
+        UnloadTexture(texture);
+    }
+}
+
+TileRect LevelView::visibleTiles() const {
+    const float screenWidth = static_cast<float>(GetScreenWidth());
+    const float screenHeight = static_cast<float>(GetScreenHeight());
+    const Vector2 corners[] = {
+        GetScreenToWorld2D({0.0f, 0.0f}, camera),
+        GetScreenToWorld2D({screenWidth, 0.0f}, camera),
+        GetScreenToWorld2D({0.0f, screenHeight}, camera),
+        GetScreenToWorld2D({screenWidth, screenHeight}, camera)};
+
+    Vector2 min = corners[0];
+    Vector2 max = corners[0];
+    for (const Vector2 &corner : corners) {
+        min = {std::min(min.x, corner.x), std::min(min.y, corner.y)};
+        max = {std::max(max.x, corner.x), std::max(max.y, corner.y)};
+    }
+
+    // Tiles that hang into view from neighbouring cells are picked up by
+    // TileBatcher, in the chunks too.
+    return map.tileLayer.cellsCovering(min.x, min.y, max.x, max.y);
+}
+
+void LevelView::draw() {
+    map.registry.view<const PhysicsComponent, const PlayerComponent>().each(
+        [this](const PhysicsComponent &physC, const PlayerComponent &) {
+            camera.target = {physC.x, physC.y};
+        });
+    camera.offset = {GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f};
+    TileRect visible = visibleTiles();
+    tileChunks.update(map.tileLayer, visible, textures);
+    BeginMode2D(camera);
+
+    tileChunks.draw(map.tileLayer, visible);
+
+    auto drawingView =
+        map.registry.view<const PhysicsComponent, const HitboxComponent>();
+    drawingView.each(
+        [](const PhysicsComponent &position, const HitboxComponent &hitbox) {
+            DrawRectangleRec({position.x - (hitbox.width / 2.0f),
+                              position.y - (hitbox.height / 2.0f),
+                              hitbox.width, hitbox.height},
+                             RED);
+        });
+
+    std::span<const baked::Point> points = map.level.colliderPoints();
+    for (const baked::Loop &loop : map.level.colliderLoops()) {
+        for (uint32_t i = 0; i < loop.pointCount; ++i) {
+            const baked::Point &from = points[loop.firstPoint + i];
+            const baked::Point &to =
+                points[loop.firstPoint + (i + 1) % loop.pointCount];
+            DrawLineV({from.x, from.y}, {to.x, to.y}, WHITE);
+        }
+    }
+
+    EndMode2D();
+}
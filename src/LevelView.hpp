@@ -0,0 +1,49 @@
+#pragma once
+#include <raylib.h>
+#include "ImageCache.hpp"
+#include "MapLevel.hpp"
+#include "TileChunkCache.hpp"
+#include <filesystem>
+#include <vector>
+
+// Keyboard state for the current frame.
+PlayerInput pollInput();
+
+// Decodes the tileset images of a level, indexed like level.tilesets(), on
+// several threads, through the image cache in resources/.cache. A tileset
+// that shares its image file with an earlier one gets an empty image. Only
+// touches the CPU side of raylib, so it can run on a loading thread.
+std::vector<CachedImage>
+loadTilesetImages(const BakedLevel &level,
+                  const std::filesystem::path &resources);
+
+// Copies images, from loadTilesetImages(), into the pages of atlas. Returns
+// images indexed like atlas.pages(); also CPU only.
+std::vector<CachedImage> buildAtlasPages(const TileAtlas &atlas,
+                                         std::vector<CachedImage> images);
+
+// A progress bar with the name of the current stage.
+void drawLoadingScreen(const LoadProgress &progress);
+
+// Draws a MapLevel with raylib. Owns everything that needs a GL context, so
+// the level itself can be simulated headless.
+class LevelView {
+
+  public:
+    // Uploads pages, from buildAtlasPages(), to the GPU and frees them.
+    LevelView(const MapLevel &map, const TileAtlas &atlas,
+              std::vector<CachedImage> pages);
+    LevelView(const LevelView &) = delete;
+    LevelView &operator=(const LevelView &) = delete;
+    ~LevelView();
+
+    TileRect visibleTiles() const;
+    void draw();
+
+    Camera2D camera;
+
+  private:
+    const MapLevel &map;
+    TileChunkCache tileChunks;
+    std::vector<Texture2D> textures; // Indexed like TileAtlas::pages()
+};
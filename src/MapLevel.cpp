@@ -1,197 +1,238 @@
 #include "MapLevel.hpp"
+#include "CharacterController.hpp"
+#include "LevelBaker.hpp"
 #include "box2d/b2_body.h"
+#include "box2d/b2_chain_shape.h"
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_math.h"
 #include "box2d/b2_polygon_shape.h"
-#include "src/tileson.hpp"
 #include <algorithm>
-#include <raylib.h>
-
-constexpr float BOX2D_SCALE = 1.0f / 16.0f;
-constexpr float toBox2D(float px) { return px * BOX2D_SCALE; }
-constexpr float fromBox2D(float m) { return m / BOX2D_SCALE; }
-
-void MapLevel::collide(float x, float y, PhysicsComponent &physC,
-                       HitboxComponent &hitbox) {
-    tson::TileObject *tileObject = tileLayer->getTileObject(
-        x / tsonMap->getTileSize().x, y / tsonMap->getTileSize().y);
-    if (tileObject != nullptr) {
-        tson::Vector2f tilePos = tileObject->getPosition();
-        for (const tson::Object &object :
-             tileObject->getTile()->getObjectgroup().getObjects()) {
-            if (object.getObjectType() == tson::ObjectType::Rectangle) {
-                tson::Vector2i bbSize = object.getSize();
-                tson::Vector2i bbPos = object.getPosition();
-
-                Rectangle collision =
-                    GetCollisionRec({physC.x + hitbox.x, physC.y + hitbox.y,
-                                     hitbox.width, hitbox.height},
-                                    {tilePos.x + bbPos.x, tilePos.y + bbPos.y,
-                                     static_cast<float>(bbSize.x),
-                                     static_cast<float>(bbSize.y)});
-
-                if (collision.width != collision.height &&
-                    collision.width != 0 && collision.height != 0) {
-                    if (collision.width < collision.height &&
-                        physC.x < tilePos.x) {
-                        physC.x -= collision.width;
-                        physC.xVelocity = 0;
-                    } else if (collision.width < collision.height &&
-                               physC.x > tilePos.x) {
-                        physC.x += collision.width;
-                        physC.xVelocity = 0;
-                    }
-
-                    if (collision.width > collision.height &&
-                        tilePos.y + 1 < physC.y + hitbox.y) {
-                        physC.y += collision.height;
-                        physC.yVelocity = 0.0f;
-                    } else if (collision.width > collision.height &&
-                               tilePos.y) {
-                        physC.y -= collision.height;
-                        physC.yVelocity = 0.0f;
-                        physC.isOnGround = true;
-                    }
-                }
-            }
-        }
-    }
-}
+#include <fstream>
+#include <string_view>
 
 MapLevel::MapLevel(tson::Tileson &tileson,
-                   const std::filesystem::path &resources)
-    : tsonMap(tileson.parse(resources / "level.json")),
-      tileLayer(tsonMap->getLayer("Tile Layer 1")),
-      objectLayer(tsonMap->getLayer("Object Layer 1")),
-      colliderLayer(tsonMap->getLayer("collider layer")), world({0.0f, 10.0f}) {
-    for (tson::Tileset &tileset : tsonMap->getTilesets()) {
-        textures.emplace(&tileset,
-                         LoadTexture((resources / tileset.getImage()).c_str()));
+                   const std::filesystem::path &resources,
+                   LoadProgress *progress)
+    : world({0.0f, 10.0f}) {
+    world.SetContactListener(&groundContacts);
+    auto report = [progress](const char *stage, float fraction) {
+        if (progress != nullptr) {
+            progress->report(stage, fraction);
+        }
+    };
+
+    // Prefer the baked level. When it is missing or older than level.json,
+    // bake the JSON and cache the result for the next start.
+    std::filesystem::path baked = resources / "level.bin";
+    std::filesystem::path json = resources / "level.json";
+    std::error_code error;
+    bool bakedIsFresh =
+        !std::filesystem::exists(json, error) ||
+        std::filesystem::last_write_time(baked, error) >=
+            std::filesystem::last_write_time(json, error);
+    report("Reading level", 0.0f);
+    if (error || !bakedIsFresh || !level.open(baked)) {
+        report("Baking level.json", 0.1f);
+        std::vector<std::byte> bytes = bakeLevel(tileson, json);
+        if (bytes.empty()) {
+            return; // Leaves the level closed
+        }
+        // Written to a temporary file and renamed into place, so a failed
+        // write never replaces a good cache or one another process maps.
+        std::filesystem::path temporary = baked;
+        temporary += ".tmp";
+        std::ofstream cache(temporary, std::ios::binary | std::ios::trunc);
+        cache.write(reinterpret_cast<const char *>(bytes.data()),
+                    static_cast<std::streamsize>(bytes.size()));
+        cache.close();
+        bool cached = static_cast<bool>(cache);
+        // Only a level that reads back is worth caching.
+        const bool valid = level.adopt(std::move(bytes));
+        std::error_code cacheError;
+        if (cached && valid) {
+            std::filesystem::rename(temporary, baked, cacheError);
+            cached = !cacheError;
+        }
+        if (!cached || !valid) {
+            std::filesystem::remove(temporary, cacheError);
+        }
+        if (!valid) {
+            return;
+        }
     }
-
-    for (const tson::Object &collider : colliderLayer->getObjects()) {
-        tson::Vector2i pos = collider.getPosition();
-        tson::Vector2i size = collider.getSize();
-        b2BodyDef groundBodyDef;
-        groundBodyDef.position.Set(toBox2D(pos.x + (size.x / 2.0f)),
-                                   toBox2D(pos.y + (size.y / 2.0f)));
-        b2Body *groundBody = world.CreateBody(&groundBodyDef);
-        b2PolygonShape groundBox;
-        groundBox.SetAsBox(toBox2D(size.x / 2.0f), toBox2D(size.y / 2.0f));
-        groundBody->CreateFixture(&groundBox, 0.0f);
+    tileLayer = TileLayer(level);
+    collisionGrid = CollisionGrid(tileLayer);
+
+    report("Building colliders", 0.7f);
+    // All static geometry lives on one body, as the seam-free outlines of
+    // the merged colliders.
+    b2BodyDef groundBodyDef;
+    b2Body *groundBody = world.CreateBody(&groundBodyDef);
+    std::span<const baked::Point> points = level.colliderPoints();
+    std::vector<b2Vec2> vertices;
+    for (const baked::Loop &loop : level.colliderLoops()) {
+        vertices.clear();
+        for (const baked::Point &point :
+             points.subspan(loop.firstPoint, loop.pointCount)) {
+            vertices.emplace_back(toBox2D(point.x), toBox2D(point.y));
+        }
+        b2ChainShape groundChain;
+        groundChain.CreateLoop(vertices.data(),
+                               static_cast<int32>(vertices.size()));
+        groundBody->CreateFixture(&groundChain, 0.0f);
     }
 
-    entt::entity entity = registry.create();
-    tson::Object *playerObject = objectLayer->firstObj("player");
-    tson::Vector2i pos;
+    report("Spawning entities", 0.9f);
+    const baked::Object *playerObject = level.firstObject("player");
+    baked::Point pos = {0.0f, 0.0f};
 
     if (playerObject != nullptr) {
-        pos = playerObject->getPosition();
+        pos = {playerObject->bounds.x, playerObject->bounds.y};
+    }
+    registry.emplace<PlayerComponent>(spawnCharacter(pos.x, pos.y));
+
+    for (const baked::Object &object : level.objects()) {
+        std::string_view type = level.string(object.type);
+        if (type == "enemy") {
+            spawnCharacter(object.bounds.x, object.bounds.y);
+        } else if (type == "prop") {
+            spawnProp(object.bounds.x, object.bounds.y);
+        }
     }
+}
+
+entt::entity MapLevel::spawnCharacter(float x, float y) {
+    // Characters are on the tile controller rather than Box2D bodies; the
+    // player's 16x16 box covers the same pixels its body used to.
+    constexpr float CHARACTER_HALF_SIZE = 8.0f;
+    const entt::entity entity = registry.create();
+    const float feet = y + CHARACTER_HALF_SIZE;
+    registry.emplace<CharacterComponent>(
+        entity, x, feet, x, feet, 0.0f, 0.0f, CHARACTER_HALF_SIZE,
+        2.0f * CHARACTER_HALF_SIZE, CHARACTER_HALF_SIZE, false, false);
+    registry.emplace<PhysicsComponent>(entity, x, y, 0.0f, 0.0f, false,
+                                       nullptr, b2Vec2{0.0f, 0.0f});
+    registry.emplace<HitboxComponent>(entity, -CHARACTER_HALF_SIZE,
+                                      -2.0f * CHARACTER_HALF_SIZE,
+                                      2.0f * CHARACTER_HALF_SIZE,
+                                      2.0f * CHARACTER_HALF_SIZE);
+    return entity;
+}
 
-    b2BodyDef playerBodyDef;
-    playerBodyDef.type = b2_dynamicBody;
-    playerBodyDef.fixedRotation = true;
-    playerBodyDef.position.Set(toBox2D(pos.x), toBox2D(pos.y));
-    // playerBodyDef.linearDamping = 0.04f;
-    b2Body *playerBody = world.CreateBody(&playerBodyDef);
-    b2PolygonShape dynamicBox;
-    dynamicBox.SetAsBox(toBox2D(16.0f / 2.0f), toBox2D(16.0f / 2.0f));
+entt::entity MapLevel::spawnProp(float x, float y) {
+    constexpr float PROP_HALF_SIZE = 8.0f;
+    const entt::entity entity = registry.create();
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_dynamicBody;
+    bodyDef.fixedRotation = true;
+    bodyDef.position.Set(toBox2D(x), toBox2D(y));
+    b2Body *body = world.CreateBody(&bodyDef);
+    b2PolygonShape box;
+    box.SetAsBox(toBox2D(PROP_HALF_SIZE), toBox2D(PROP_HALF_SIZE));
     b2FixtureDef fixtureDef;
-    fixtureDef.shape = &dynamicBox;
+    fixtureDef.shape = &box;
     fixtureDef.density = 1.0f;
-    fixtureDef.friction = 0.0f;
-    playerBody->CreateFixture(&fixtureDef);
-
-    registry.emplace<PhysicsComponent>(entity, pos.x, pos.y, 0.0f, 0.0f, false,
-                                       playerBody);
-    registry.emplace<HitboxComponent>(entity, -8.0f, -16.0f, 16.0f, 16.0f);
-    registry.emplace<PlayerComponent>(entity);
-
-    camera.target = {100, 20};
-    camera.offset = {GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f};
-    camera.rotation = 0.0f;
-    camera.zoom = 3.0f;
+    fixtureDef.friction = 0.6f;
+    body->CreateFixture(&fixtureDef);
+
+    registry.emplace<PhysicsComponent>(entity, x, y, 0.0f, 0.0f, false, body,
+                                       body->GetPosition());
+    registry.emplace<HitboxComponent>(entity, -PROP_HALF_SIZE,
+                                      -PROP_HALF_SIZE, 2.0f * PROP_HALF_SIZE,
+                                      2.0f * PROP_HALF_SIZE);
+    addFootSensor(registry, entity, body, toBox2D(PROP_HALF_SIZE),
+                  toBox2D(PROP_HALF_SIZE));
+    return entity;
 }
 
-void MapLevel::frame() {
-    world.Step(1.0f / 60.0f, 6, 2);
-    registry.view<PhysicsComponent, HitboxComponent, PlayerComponent>().each(
-        [this](PhysicsComponent &physC, HitboxComponent &hitbox,
-               PlayerComponent &player) {
-            {
-
-                constexpr float MOVEMENT_FORCE = 15.0f;
-                constexpr float MAX_VELOCITY = 8.0f;
-                constexpr float STOP_FORCE = 5.0f;
-                b2Vec2 velocity = physC.body->GetLinearVelocity();
-                if (IsKeyDown(KEY_A) && !IsKeyDown(KEY_D)) {
-                    if (velocity.x > -MAX_VELOCITY) {
-                        physC.body->ApplyForce({-MOVEMENT_FORCE, 0.0f},
-                                               physC.body->GetWorldCenter(),
-                                               false);
-                    }
-                } else if (IsKeyDown(KEY_D) && !IsKeyDown(KEY_A)) {
-                    if (velocity.x < MAX_VELOCITY) {
-                        physC.body->ApplyForce({MOVEMENT_FORCE, 0.0f},
-                                               physC.body->GetWorldCenter(),
-                                               false);
-                    }
-                } else {
-                    physC.body->ApplyForce({velocity.x * -STOP_FORCE, 0.0f},
-                                           physC.body->GetWorldCenter(), false);
-                }
+void MapLevel::update(float frameTime, const PlayerInput &input) {
+    pendingJump = pendingJump || input.jump;
+    accumulator += frameTime;
 
-                if (IsKeyPressed(KEY_SPACE)) {
-                    physC.body->ApplyLinearImpulseToCenter({0.0f, -5.0f},
-                                                           false);
-                }
-            }
+    int steps = 0;
+    while (accumulator >= TIME_STEP && steps < MAX_STEPS_PER_FRAME) {
+        step({input.left, input.right, pendingJump, input.down});
+        pendingJump = false;
+        accumulator -= TIME_STEP;
+        ++steps;
+    }
+    if (steps == MAX_STEPS_PER_FRAME) {
+        accumulator = std::min(accumulator, TIME_STEP);
+    }
 
-            b2Vec2 pos = physC.body->GetPosition();
-            camera.target = {fromBox2D(pos.x), fromBox2D(pos.y)};
+    // Render positions, blended between the last two physics states.
+    const float alpha = accumulator / TIME_STEP;
+    registry.view<PhysicsComponent>(entt::exclude<DormantComponent>)
+        .each([alpha](PhysicsComponent &physC) {
+            if (physC.body == nullptr) {
+                return;
+            }
+            const b2Vec2 &current = physC.body->GetPosition();
+            const b2Vec2 &previous = physC.previousPosition;
+            physC.x = fromBox2D(previous.x + (current.x - previous.x) * alpha);
+            physC.y = fromBox2D(previous.y + (current.y - previous.y) * alpha);
         });
-    camera.offset = {GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f};
-    BeginMode2D(camera);
-
-    for (auto &[pos, tileObject] : tileLayer->getTileObjects()) {
-        tson::Rect drawingRect = tileObject.getDrawingRect();
-        tson::Vector2f position = tileObject.getPosition();
-        const Texture2D &texture = textures[tileObject.getTile()->getTileset()];
-
-        DrawTextureQuad(
-            texture,
-            {static_cast<float>(drawingRect.width) / texture.width,
-             static_cast<float>(drawingRect.height) / texture.height},
-            {static_cast<float>(drawingRect.x) / texture.width,
-             static_cast<float>(drawingRect.y) / texture.height},
-            {position.x, position.y, static_cast<float>(drawingRect.width),
-             static_cast<float>(drawingRect.height)},
-            WHITE);
-    }
+    // Characters are drawn from the centre of their box, like bodies.
+    registry
+        .view<PhysicsComponent, const CharacterComponent>(
+            entt::exclude<DormantComponent>)
+        .each([alpha](PhysicsComponent &physC, const CharacterComponent &c) {
+            physC.x = c.previousX + (c.x - c.previousX) * alpha;
+            physC.y = c.previousY + (c.y - c.previousY) * alpha - c.height / 2;
+            physC.xVelocity = c.xVelocity;
+            physC.yVelocity = c.yVelocity;
+            physC.isOnGround = c.onGround;
+        });
+}
 
-    auto drawingView =
-        registry.view<const PhysicsComponent, const HitboxComponent>();
-    drawingView.each(
-        [](const PhysicsComponent &position, const HitboxComponent &hitbox) {
-            const b2Vec2 &pos = position.body->GetPosition();
-            DrawRectangleRec({fromBox2D(pos.x) - (hitbox.width / 2.0f),
-                              fromBox2D(pos.y) - (hitbox.height / 2.0f),
-                              hitbox.width, hitbox.height},
-                             RED);
+void MapLevel::step(const PlayerInput &input) {
+    activity.update(registry, time);
+    registry.view<PhysicsComponent>(entt::exclude<DormantComponent>)
+        .each([](PhysicsComponent &physC) {
+            if (physC.body != nullptr) {
+                physC.previousPosition = physC.body->GetPosition();
+            }
         });
 
-    for (const tson::Object &collider : colliderLayer->getObjects()) {
-        tson::Vector2i pos = collider.getPosition();
-        tson::Vector2i size = collider.getSize();
-        DrawRectangleLines(pos.x, pos.y, size.x, size.y, WHITE);
-    }
+    registry.view<CharacterComponent, PlayerComponent>().each(
+        [this, &input](CharacterComponent &character, PlayerComponent &player) {
+            // The feel of the old Box2D player: 15 N on 1 kg up to 8 m/s,
+            // a 5 N s jump, at 16 pixels per metre.
+            constexpr float ACCELERATION = 240.0f;
+            constexpr float MAX_SPEED = 128.0f;
+            constexpr float STOP_RATE = 5.0f; // Share of speed lost per second
+            constexpr float JUMP_SPEED = 80.0f;
+            // A jump still works this long after walking off a ledge.
+            constexpr double COYOTE_TIME = 0.1;
+
+            float &velocity = character.xVelocity;
+            if (input.left && !input.right) {
+                if (velocity > -MAX_SPEED) {
+                    velocity -= ACCELERATION * TIME_STEP;
+                }
+            } else if (input.right && !input.left) {
+                if (velocity < MAX_SPEED) {
+                    velocity += ACCELERATION * TIME_STEP;
+                }
+            } else {
+                velocity -= velocity * STOP_RATE * TIME_STEP;
+            }
 
-    EndMode2D();
-}
+            if (character.onGround) {
+                player.lastGrounded = time;
+            }
+            if (input.jump && input.down && character.onGround) {
+                character.dropDown = true;
+            } else if (input.jump &&
+                       time - player.lastGrounded <= COYOTE_TIME &&
+                       player.lastJump < player.lastGrounded) {
+                // One jump per touch of the ground
+                character.yVelocity = -JUMP_SPEED;
+                player.lastJump = time;
+            }
+        });
+    moveCharacters(registry, collisionGrid, activity, TIME_STEP);
 
-MapLevel::~MapLevel() {
-    for (auto &[tileset, texture] : textures) {
-        UnloadTexture(texture);
-    }
+    world.Step(TIME_STEP, 6, 2);
+    time += TIME_STEP;
 }
@@ -1,30 +1,73 @@
 #pragma once
-#include <raylib.h>
 #include <entt/entt.hpp>
 #include "box2d/b2_body.h"
 #include "box2d/b2_world.h"
 #include "tileson.hpp"
+#include "ActivityRegions.hpp"
+#include "BakedLevel.hpp"
+#include "CollisionGrid.hpp"
+#include "GroundContacts.hpp"
+#include "TileLayer.hpp"
 #include "components.hpp"
+#include <atomic>
 #include <box2d/box2d.h>
 
+// Simulation rate, independent of the rendering frame rate.
+constexpr float TIME_STEP = 1.0f / 60.0f;
+// Steps run per frame at most; the rest of a long frame is dropped so a slow
+// frame cannot snowball into ever more steps.
+constexpr int MAX_STEPS_PER_FRAME = 5;
+
+struct PlayerInput {
+    bool left;
+    bool right;
+    bool jump; // Edge-triggered, held until the next simulation step
+    bool down; // With jump, drops through one-way platforms
+};
+
+// How far a level load has got. Written by the loading thread and read by
+// the one drawing the loading screen.
+struct LoadProgress {
+    std::atomic<const char *> stage{"Starting"};
+    std::atomic<float> fraction{0.0f}; // 0 to 1
+
+    void report(const char *newStage, float newFraction) {
+        stage = newStage;
+        fraction = newFraction;
+    }
+};
+
+// The simulation side of a level. Nothing in here touches raylib, so it runs
+// just as well without a window; see LevelView for the presentation side.
 struct MapLevel {
 
   public:
-    std::unique_ptr<tson::Map> tsonMap;
-    tson::Layer *tileLayer;
-    tson::Layer *objectLayer;
-    tson::Layer *colliderLayer;
-
-    std::map<tson::Tileset *, Texture2D> textures;
-    Camera2D camera;
+    BakedLevel level;
+    TileLayer tileLayer;
+    CollisionGrid collisionGrid;
     entt::registry registry;
+    GroundContactListener groundContacts{registry};
+    ActivityRegions activity;
 
     b2World world;
+    double time = 0.0; // Simulated seconds
+    float accumulator = 0.0f;
+    bool pendingJump = false;
+
+    void update(float frameTime, const PlayerInput &input);
+    void step(const PlayerInput &input);
+
+    // A character on the tile controller, one tile in size, centred on x, y
+    // in pixels. The constructor spawns one for the player and one for each
+    // level object of type "enemy".
+    entt::entity spawnCharacter(float x, float y);
 
-    void collide(float x, float y, PhysicsComponent &position,
-                 HitboxComponent &hitbox);
-    void frame();
+    // A dynamic Box2D crate, one tile in size, centred on x, y in pixels.
+    // Its foot sensor lets GroundContactListener keep isOnGround up to date.
+    // Props are spawned for the objects of type "prop" in the level.
+    entt::entity spawnProp(float x, float y);
 
-    MapLevel(tson::Tileson &tileson, const std::filesystem::path &resources);
-    ~MapLevel();
+    // Touches neither raylib nor GL, so it can run on a loading thread.
+    MapLevel(tson::Tileson &tileson, const std::filesystem::path &resources,
+             LoadProgress *progress = nullptr);
 };
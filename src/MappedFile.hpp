@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+// A whole file mapped read-only into memory.
+class MappedFile {
+
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    ~MappedFile();
+
+    // Fails for missing and empty files.
+    bool open(const std::filesystem::path &path);
+    void close();
+    bool isOpen() const { return mapping != nullptr; }
+
+    std::span<const std::byte> bytes() const {
+        return {static_cast<const std::byte *>(mapping), size};
+    }
+
+  private:
+    void *mapping = nullptr;
+    size_t size = 0;
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Calls fn(i) for every i in [0, count) on up to hardware_concurrency()
+// threads, the calling one included, and returns once all calls are done.
+// Indices are handed out one at a time, so uneven work balances out.
+template <typename Fn> void parallelFor(size_t count, Fn &&fn) {
+    const size_t threads = std::min<size_t>(
+        count, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+        for (size_t i = next++; i < count; i = next++) {
+            fn(i);
+        }
+    };
+
+    std::vector<std::jthread> pool;
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back(work);
+    }
+    work();
+}
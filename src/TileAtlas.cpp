@@ -0,0 +1,85 @@
+#include "TileAtlas.hpp"
+#include <algorithm>
+
+TileAtlas::TileAtlas(const BakedLevel &level, int maxPageSize) {
+    std::span<const baked::Tileset> all = level.tilesets();
+    tilesets.assign(all.size(), Placement{UINT32_MAX, 0, 0, 0, 0});
+
+    // Tilesets often share an image file; place each file once.
+    std::vector<size_t> owner(all.size());
+    std::vector<size_t> order;
+    for (size_t i = 0; i < all.size(); ++i) {
+        owner[i] = i;
+        for (size_t j = 0; j < i; ++j) {
+            if (level.string(all[j].image) == level.string(all[i].image)) {
+                owner[i] = owner[j];
+                break;
+            }
+        }
+        if (owner[i] == i && all[i].imageWidth > 0 && all[i].imageHeight > 0) {
+            order.push_back(i);
+        }
+    }
+
+    // Shelf packing, tallest images first so each shelf wastes little.
+    std::stable_sort(order.begin(), order.end(), [all](size_t a, size_t b) {
+        return all[a].imageHeight > all[b].imageHeight;
+    });
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    bool pageClosed = false;
+    for (size_t i : order) {
+        const int width = all[i].imageWidth;
+        const int height = all[i].imageHeight;
+        const int slotWidth = width + 2 * ATLAS_PADDING;
+        const int slotHeight = height + 2 * ATLAS_PADDING;
+        const bool oversized =
+            slotWidth > maxPageSize || slotHeight > maxPageSize;
+        const bool pageEmpty =
+            atlasPages.empty() || (shelfX == 0 && shelfY == 0);
+        if (!pageEmpty && shelfX + slotWidth > maxPageSize) {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+        // An image larger than a page gets a page of its own, which nothing
+        // else goes on afterwards either.
+        if (atlasPages.empty() || pageClosed ||
+            (!pageEmpty && (oversized || shelfY + slotHeight > maxPageSize))) {
+            atlasPages.push_back({0, 0});
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+        pageClosed = oversized;
+
+        Page &page = atlasPages.back();
+        tilesets[i] = {static_cast<uint32_t>(atlasPages.size() - 1),
+                       shelfX + ATLAS_PADDING, shelfY + ATLAS_PADDING, width,
+                       height};
+        shelfX += slotWidth;
+        shelfHeight = std::max(shelfHeight, slotHeight);
+        page.width = std::max(page.width, shelfX);
+        page.height = std::max(page.height, shelfY + slotHeight);
+    }
+
+    // Nothing to bleed into on a page of one image, and buildAtlasPages()
+    // can then use the image as it is.
+    std::vector<int> imagesOnPage(atlasPages.size(), 0);
+    for (size_t i : order) {
+        ++imagesOnPage[tilesets[i].page];
+    }
+    for (size_t i : order) {
+        Placement &placement = tilesets[i];
+        if (imagesOnPage[placement.page] == 1) {
+            placement.x = 0;
+            placement.y = 0;
+            atlasPages[placement.page] = {placement.width, placement.height};
+        }
+    }
+
+    for (size_t i = 0; i < all.size(); ++i) {
+        tilesets[i] = tilesets[owner[i]];
+    }
+}
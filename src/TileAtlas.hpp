@@ -0,0 +1,47 @@
+#pragma once
+#include "BakedLevel.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Longest side of an atlas page. Every GPU raylib targets supports textures
+// at least this large.
+constexpr int ATLAS_PAGE_SIZE = 4096;
+// Pixels around each image on a shared page. buildAtlasPages() fills them
+// with copies of the image's edges, so filtering and rounding at the border
+// of a tile never pick up the image next to it.
+constexpr int ATLAS_PADDING = 1;
+
+// Packs the tileset images of a level into as few atlas pages as possible,
+// so tiles from different tilesets can be drawn with one texture bind. Only
+// the layout; the pixels are copied by buildAtlasPages().
+class TileAtlas {
+
+  public:
+    struct Placement {
+        uint32_t page;
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct Page {
+        int width;
+        int height;
+    };
+
+    TileAtlas() = default;
+    explicit TileAtlas(const BakedLevel &level,
+                       int maxPageSize = ATLAS_PAGE_SIZE);
+
+    // Indexed like BakedLevel::tilesets(). Tilesets that share an image file
+    // share its placement. Tilesets without an image have no pixels and are
+    // on no page. An image alone on its page fills it without padding.
+    std::span<const Placement> placements() const { return tilesets; }
+    std::span<const Page> pages() const { return atlasPages; }
+
+  private:
+    std::vector<Placement> tilesets;
+    std::vector<Page> atlasPages;
+};
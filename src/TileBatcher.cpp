@@ -0,0 +1,62 @@
+#include "TileBatcher.hpp"
+
+TileBatcher::TileBatcher(const BakedLevel &level, const TileAtlas &atlas)
+    : uvs(level.tiles().size(), baked::Rect{}),
+      pageBatches(atlas.pages().size()) {
+    std::span<const TileAtlas::Placement> placements = atlas.placements();
+    std::span<const TileAtlas::Page> pages = atlas.pages();
+    for (const TileAtlas::Placement &placement : placements) {
+        tilesetPages.push_back(placement.page);
+    }
+
+    std::span<const baked::Tile> tiles = level.tiles();
+    for (size_t gid = 1; gid < tiles.size(); ++gid) {
+        const baked::Tile &tile = tiles[gid];
+        if (tile.tileset >= placements.size() ||
+            placements[tile.tileset].page >= pages.size()) {
+            continue;
+        }
+        const TileAtlas::Placement &placement = placements[tile.tileset];
+        const float width = static_cast<float>(pages[placement.page].width);
+        const float height =
+            static_cast<float>(pages[placement.page].height);
+        uvs[gid] = {(placement.x + tile.source.x) / width,
+                    (placement.y + tile.source.y) / height,
+                    tile.source.width / width, tile.source.height / height};
+    }
+}
+
+void TileBatcher::build(const TileLayer &layer, TileRect rect) {
+    for (TileBatch &batch : pageBatches) {
+        batch.clear();
+    }
+
+    const float tileWidth = static_cast<float>(layer.tileWidth());
+    const float tileHeight = static_cast<float>(layer.tileHeight());
+    layer.forEachTileIn(layer.withOverhang(rect), [&](int x, int y,
+                                                      const baked::Tile &tile) {
+        if (tile.tileset >= tilesetPages.size() ||
+            tilesetPages[tile.tileset] >= pageBatches.size()) {
+            return; // No image to draw it from
+        }
+        TileBatch &batch = pageBatches[tilesetPages[tile.tileset]];
+        const baked::Rect &uv = uvs[layer.gidOf(tile)];
+
+        // Tiled anchors tiles to the bottom left of their cell, like the
+        // colliders from collectColliders().
+        const float left = x * tileWidth;
+        const float top = (y + 1) * tileHeight - tile.source.height;
+        const float right = left + tile.source.width;
+        const float bottom = top + tile.source.height;
+        batch.positions.insert(batch.positions.end(), {left, top, left, bottom,
+                                                       right, bottom, right,
+                                                       top});
+
+        const float u0 = uv.x;
+        const float v0 = uv.y;
+        const float u1 = uv.x + uv.width;
+        const float v1 = uv.y + uv.height;
+        batch.texcoords.insert(batch.texcoords.end(),
+                               {u0, v0, u0, v1, u1, v1, u1, v0});
+    });
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "BakedLevel.hpp"
+#include "TileAtlas.hpp"
+#include "TileLayer.hpp"
+#include <span>
+#include <vector>
+
+// Quads for every visible tile on one atlas page, four vertices per quad in
+// counter-clockwise order. Positions are in pixels, texcoords normalized.
+struct TileBatch {
+    std::vector<float> positions; // x, y per vertex
+    std::vector<float> texcoords; // u, v per vertex
+
+    size_t quadCount() const { return positions.size() / 8; }
+    void clear() {
+        positions.clear();
+        texcoords.clear();
+    }
+};
+
+// Builds per-page vertex arrays on the CPU. Kept free of any graphics API
+// so it can run without a GL context.
+class TileBatcher {
+
+  public:
+    TileBatcher() = default;
+    TileBatcher(const BakedLevel &level, const TileAtlas &atlas);
+
+    // Quads for every tile that covers part of the cells in rect, including
+    // tiles from neighbouring cells that are larger than the grid.
+    void build(const TileLayer &layer, TileRect rect);
+
+    // One batch per atlas page, indexed like TileAtlas::pages().
+    std::span<const TileBatch> batches() const { return pageBatches; }
+
+  private:
+    std::vector<baked::Rect> uvs; // Normalized rect in its page, by gid
+    std::vector<uint32_t> tilesetPages; // Indexed like BakedLevel::tilesets()
+    std::vector<TileBatch> pageBatches;
+};
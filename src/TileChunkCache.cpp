@@ -0,0 +1,139 @@
+#include "TileChunkCache.hpp"
+#include <algorithm>
+#include <rlgl.h>
+#include <utility>
+
+// Frames a chunk may stay off screen before its texture is released.
+constexpr uint64_t CHUNK_EVICT_FRAMES = 300;
+
+TileChunkCache::TileChunkCache(const BakedLevel &level,
+                               const TileAtlas &atlas)
+    : renderer(level, atlas),
+      chunksX((level.width() + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE) {
+    int chunksY = (level.height() + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    chunks.resize(static_cast<size_t>(chunksX) * chunksY);
+}
+
+TileChunkCache::TileChunkCache(TileChunkCache &&other) noexcept {
+    *this = std::move(other);
+}
+
+TileChunkCache &TileChunkCache::operator=(TileChunkCache &&other) noexcept {
+    if (this != &other) {
+        for (size_t index : resident) {
+            release(chunks[index]);
+        }
+        renderer = std::move(other.renderer);
+        chunks = std::exchange(other.chunks, {});
+        resident = std::exchange(other.resident, {});
+        chunksX = other.chunksX;
+        frame = other.frame;
+    }
+    return *this;
+}
+
+TileChunkCache::~TileChunkCache() {
+    for (size_t index : resident) {
+        release(chunks[index]);
+    }
+}
+
+TileRect TileChunkCache::chunksCovering(TileRect rect) const {
+    return {rect.x0 / TILE_CHUNK_SIZE, rect.y0 / TILE_CHUNK_SIZE,
+            (rect.x1 + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE,
+            (rect.y1 + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE};
+}
+
+void TileChunkCache::update(const TileLayer &layer, TileRect rect,
+                            std::span<const Texture2D> textures) {
+    ++frame;
+    TileRect visible = chunksCovering(layer.clamp(rect));
+    for (int chunkY = visible.y0; chunkY < visible.y1; ++chunkY) {
+        for (int chunkX = visible.x0; chunkX < visible.x1; ++chunkX) {
+            Chunk &chunk =
+                chunks[static_cast<size_t>(chunkY) * chunksX + chunkX];
+            chunk.lastUsedFrame = frame;
+            if (!chunk.built ||
+                chunk.revision != layer.getChunkRevision(chunkX, chunkY)) {
+                render(layer, chunkX, chunkY, chunk, textures);
+            }
+        }
+    }
+
+    std::erase_if(resident, [this](size_t index) {
+        Chunk &chunk = chunks[index];
+        if (frame - chunk.lastUsedFrame <= CHUNK_EVICT_FRAMES) {
+            return false;
+        }
+        release(chunk);
+        return true;
+    });
+}
+
+void TileChunkCache::render(const TileLayer &layer, int chunkX, int chunkY,
+                            Chunk &chunk,
+                            std::span<const Texture2D> textures) {
+    const int originX = chunkX * TILE_CHUNK_SIZE;
+    const int originY = chunkY * TILE_CHUNK_SIZE;
+    const bool empty =
+        renderer.prepare(layer, {originX, originY, originX + TILE_CHUNK_SIZE,
+                                 originY + TILE_CHUNK_SIZE}) == 0;
+    if (empty && chunk.target.id != 0) {
+        release(chunk);
+        std::erase(resident, static_cast<size_t>(&chunk - chunks.data()));
+    }
+    chunk.revision = layer.getChunkRevision(chunkX, chunkY);
+    chunk.lastUsedFrame = frame;
+    chunk.built = true;
+    chunk.empty = empty;
+    if (empty) {
+        return;
+    }
+
+    if (chunk.target.id == 0) {
+        chunk.target = LoadRenderTexture(TILE_CHUNK_SIZE * layer.tileWidth(),
+                                         TILE_CHUNK_SIZE * layer.tileHeight());
+        resident.push_back(static_cast<size_t>(&chunk - chunks.data()));
+    }
+
+    // Tileset pixels are premultiplied, see loadCachedImage(), which also
+    // keeps the chunk's own alpha right for drawing it later.
+    BeginTextureMode(chunk.target);
+    ClearBackground(BLANK);
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    rlPushMatrix();
+    rlTranslatef(static_cast<float>(-originX * layer.tileWidth()),
+                 static_cast<float>(-originY * layer.tileHeight()), 0.0f);
+    renderer.submit(textures);
+    rlPopMatrix();
+    EndBlendMode();
+    EndTextureMode();
+}
+
+void TileChunkCache::draw(const TileLayer &layer, TileRect rect) const {
+    const float width = static_cast<float>(TILE_CHUNK_SIZE * layer.tileWidth());
+    const float height =
+        static_cast<float>(TILE_CHUNK_SIZE * layer.tileHeight());
+    TileRect visible = chunksCovering(layer.clamp(rect));
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    for (int chunkY = visible.y0; chunkY < visible.y1; ++chunkY) {
+        for (int chunkX = visible.x0; chunkX < visible.x1; ++chunkX) {
+            const Chunk &chunk =
+                chunks[static_cast<size_t>(chunkY) * chunksX + chunkX];
+            if (!chunk.built || chunk.empty) {
+                continue;
+            }
+            // Render textures are stored upside down.
+            DrawTextureRec(chunk.target.texture, {0.0f, 0.0f, width, -height},
+                           {chunkX * width, chunkY * height}, WHITE);
+        }
+    }
+    EndBlendMode();
+}
+
+void TileChunkCache::release(Chunk &chunk) {
+    if (chunk.target.id != 0) {
+        UnloadRenderTexture(chunk.target);
+    }
+    chunk = Chunk{};
+}
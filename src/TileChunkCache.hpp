@@ -0,0 +1,51 @@
+#pragma once
+#include "TileLayer.hpp"
+#include "TileRenderer.hpp"
+#include <raylib.h>
+#include <span>
+#include <vector>
+
+// Keeps static tile layers pre-rendered into one render texture per
+// TILE_CHUNK_SIZE x TILE_CHUNK_SIZE chunk. A chunk is re-rendered only when
+// its revision in the TileLayer changes, and released once it has been off
+// screen for a while.
+class TileChunkCache {
+
+  public:
+    TileChunkCache() = default;
+    TileChunkCache(const BakedLevel &level, const TileAtlas &atlas);
+    TileChunkCache(const TileChunkCache &) = delete;
+    TileChunkCache &operator=(const TileChunkCache &) = delete;
+    TileChunkCache(TileChunkCache &&other) noexcept;
+    TileChunkCache &operator=(TileChunkCache &&other) noexcept;
+    ~TileChunkCache();
+
+    // Renders missing or outdated chunks overlapping rect, with textures
+    // indexed like TileAtlas::pages(). Must be called outside of
+    // BeginMode2D/EndMode2D.
+    void update(const TileLayer &layer, TileRect rect,
+                std::span<const Texture2D> textures);
+
+    // Draws the chunks overlapping rect in world space.
+    void draw(const TileLayer &layer, TileRect rect) const;
+
+  private:
+    struct Chunk {
+        RenderTexture2D target{};
+        uint32_t revision = 0;
+        uint64_t lastUsedFrame = 0;
+        bool built = false;
+        bool empty = false;
+    };
+
+    TileRect chunksCovering(TileRect rect) const;
+    void render(const TileLayer &layer, int chunkX, int chunkY, Chunk &chunk,
+                std::span<const Texture2D> textures);
+    void release(Chunk &chunk);
+
+    TileRenderer renderer;
+    std::vector<Chunk> chunks;
+    std::vector<size_t> resident; // Indices of chunks that own a texture
+    int chunksX = 0;
+    uint64_t frame = 0;
+};
@@ -0,0 +1,52 @@
+#include "TileLayer.hpp"
+#include <algorithm>
+#include <cmath>
+
+TileLayer::TileLayer(const BakedLevel &level)
+    : layerWidth(level.width()), layerHeight(level.height()),
+      tilePixelWidth(level.tileWidth()), tilePixelHeight(level.tileHeight()),
+      cells(level.grid().begin(), level.grid().end()), tiles(level.tiles()),
+      tileShapes(level.tileShapes()) {
+    chunkRevisions.assign(static_cast<size_t>(chunksX()) * chunksY(), 0);
+    for (size_t gid = 1; gid < tiles.size(); ++gid) {
+        const baked::Rect &source = tiles[gid].source;
+        overhangX = std::max(
+            overhangX,
+            static_cast<int>(std::ceil(source.width / tilePixelWidth)) - 1);
+        overhangY = std::max(
+            overhangY,
+            static_cast<int>(std::ceil(source.height / tilePixelHeight)) - 1);
+    }
+}
+
+void TileLayer::setCell(int x, int y, uint32_t cell) {
+    if (!contains(x, y) || cells[index(x, y)] == cell) {
+        return;
+    }
+    cells[index(x, y)] = cell;
+    // Every chunk the old or the new tile may cover
+    TileRect reach = clamp({x, y - overhangY, x + overhangX + 1, y + 1});
+    for (int chunkY = reach.y0 / TILE_CHUNK_SIZE;
+         chunkY <= (reach.y1 - 1) / TILE_CHUNK_SIZE; ++chunkY) {
+        for (int chunkX = reach.x0 / TILE_CHUNK_SIZE;
+             chunkX <= (reach.x1 - 1) / TILE_CHUNK_SIZE; ++chunkX) {
+            ++chunkRevisions[static_cast<size_t>(chunkY) * chunksX() + chunkX];
+        }
+    }
+}
+
+TileRect TileLayer::clamp(TileRect rect) const {
+    rect.x0 = std::clamp(rect.x0, 0, layerWidth);
+    rect.y0 = std::clamp(rect.y0, 0, layerHeight);
+    rect.x1 = std::clamp(rect.x1, rect.x0, layerWidth);
+    rect.y1 = std::clamp(rect.y1, rect.y0, layerHeight);
+    return rect;
+}
+
+TileRect TileLayer::cellsCovering(float left, float top, float right,
+                                  float bottom) const {
+    return clamp({static_cast<int>(std::floor(left / tilePixelWidth)),
+                  static_cast<int>(std::floor(top / tilePixelHeight)),
+                  static_cast<int>(std::ceil(right / tilePixelWidth)),
+                  static_cast<int>(std::ceil(bottom / tilePixelHeight))});
+}
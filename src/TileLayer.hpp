@@ -0,0 +1,129 @@
+#pragma once
+#include "BakedLevel.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Width and height, in tiles, of the blocks that TileLayer tracks changes for.
+constexpr int TILE_CHUNK_SIZE = 32;
+
+// Half-open rectangle of cells, [x0, x1) x [y0, y1).
+struct TileRect {
+    int x0;
+    int y0;
+    int x1;
+    int y1;
+};
+
+// Runtime tile storage: one gid per cell in a row-major array, so lookups are
+// a single index and iteration walks memory linearly.
+class TileLayer {
+
+  public:
+    TileLayer() = default;
+    explicit TileLayer(const BakedLevel &level);
+
+    int width() const { return layerWidth; }
+    int height() const { return layerHeight; }
+    int tileWidth() const { return tilePixelWidth; }
+    int tileHeight() const { return tilePixelHeight; }
+
+    bool contains(int x, int y) const {
+        return x >= 0 && y >= 0 && x < layerWidth && y < layerHeight;
+    }
+
+    // Raw cell value including flip flags, 0 when empty or outside the layer.
+    uint32_t getCell(int x, int y) const {
+        return contains(x, y) ? cells[index(x, y)] : 0;
+    }
+
+    const baked::Tile *getTile(int x, int y) const {
+        return tileOf(getCell(x, y));
+    }
+
+    void setCell(int x, int y, uint32_t cell);
+
+    int chunksX() const {
+        return (layerWidth + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    }
+    int chunksY() const {
+        return (layerHeight + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    }
+
+    // Bumped every time a cell inside the chunk changes, or one outside it
+    // whose tile can reach into it.
+    uint32_t getChunkRevision(int chunkX, int chunkY) const {
+        return chunkRevisions[static_cast<size_t>(chunkY) * chunksX() + chunkX];
+    }
+
+    // Gid of a tile returned by this layer, without flip flags.
+    uint32_t gidOf(const baked::Tile &tile) const {
+        return static_cast<uint32_t>(&tile - tiles.data());
+    }
+
+    std::span<const baked::Rect> getShapes(const baked::Tile &tile) const {
+        return tileShapes.subspan(tile.firstShape, tile.shapeCount);
+    }
+
+    // Calls fn(x, y, tile) for every non-empty cell in row-major order.
+    template <typename Fn> void forEachTile(Fn &&fn) const {
+        size_t i = 0;
+        for (int y = 0; y < layerHeight; ++y) {
+            for (int x = 0; x < layerWidth; ++x, ++i) {
+                if (const baked::Tile *tile = tileOf(cells[i])) {
+                    fn(x, y, *tile);
+                }
+            }
+        }
+    }
+
+    // Calls fn(x, y, tile) for every non-empty cell inside rect, visiting only
+    // the rows and columns it covers.
+    template <typename Fn> void forEachTileIn(TileRect rect, Fn &&fn) const {
+        rect = clamp(rect);
+        for (int y = rect.y0; y < rect.y1; ++y) {
+            const uint32_t *row = cells.data() + index(0, y);
+            for (int x = rect.x0; x < rect.x1; ++x) {
+                if (const baked::Tile *tile = tileOf(row[x])) {
+                    fn(x, y, *tile);
+                }
+            }
+        }
+    }
+
+    TileRect clamp(TileRect rect) const;
+
+    // Cells whose tiles can cover part of rect. Tiles larger than the grid
+    // are anchored to the bottom left of their cell, so they reach into the
+    // cells to the right and above.
+    TileRect withOverhang(TileRect rect) const {
+        return clamp({rect.x0 - overhangX, rect.y0, rect.x1,
+                      rect.y1 + overhangY});
+    }
+
+    // Cells touched by the pixel-space rectangle [left, right) x [top, bottom).
+    TileRect cellsCovering(float left, float top, float right,
+                           float bottom) const;
+
+  private:
+    size_t index(int x, int y) const {
+        return static_cast<size_t>(y) * layerWidth + x;
+    }
+
+    const baked::Tile *tileOf(uint32_t cell) const {
+        uint32_t gid = baked::gidOf(cell);
+        return (gid != 0 && gid < tiles.size()) ? &tiles[gid] : nullptr;
+    }
+
+    int layerWidth = 0;
+    int layerHeight = 0;
+    int tilePixelWidth = 0;
+    int tilePixelHeight = 0;
+    int overhangX = 0; // Cells the widest tile reaches past its own
+    int overhangY = 0;
+
+    std::vector<uint32_t> cells;
+    std::vector<uint32_t> chunkRevisions;
+    std::span<const baked::Tile> tiles;
+    std::span<const baked::Rect> tileShapes;
+};
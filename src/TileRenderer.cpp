@@ -0,0 +1,55 @@
+#include "TileRenderer.hpp"
+#include <algorithm>
+#include <rlgl.h>
+
+// Quads submitted between batch limit checks, well below rlgl's default
+// buffer of 8192 quads.
+constexpr size_t QUADS_PER_SUBMIT = 1024;
+
+void TileRenderer::draw(const TileLayer &layer, TileRect rect,
+                        std::span<const Texture2D> textures) {
+    prepare(layer, rect);
+    submit(textures);
+}
+
+size_t TileRenderer::prepare(const TileLayer &layer, TileRect rect) {
+    batcher.build(layer, rect);
+
+    size_t quads = 0;
+    for (const TileBatch &batch : batcher.batches()) {
+        quads += batch.quadCount();
+    }
+    return quads;
+}
+
+void TileRenderer::submit(std::span<const Texture2D> textures) {
+    std::span<const TileBatch> batches = batcher.batches();
+    for (size_t page = 0; page < batches.size(); ++page) {
+        const TileBatch &batch = batches[page];
+        if (batch.quadCount() == 0) {
+            continue;
+        }
+
+        const float *position = batch.positions.data();
+        const float *texcoord = batch.texcoords.data();
+        rlSetTexture(textures[page].id);
+        for (size_t first = 0; first < batch.quadCount();
+             first += QUADS_PER_SUBMIT) {
+            size_t count =
+                std::min(QUADS_PER_SUBMIT, batch.quadCount() - first);
+            rlCheckRenderBatchLimit(static_cast<int>(count * 4));
+
+            rlBegin(RL_QUADS);
+            rlColor4ub(255, 255, 255, 255);
+            rlNormal3f(0.0f, 0.0f, 1.0f);
+            for (size_t vertex = 0; vertex < count * 4; ++vertex) {
+                rlTexCoord2f(texcoord[0], texcoord[1]);
+                rlVertex2f(position[0], position[1]);
+                texcoord += 2;
+                position += 2;
+            }
+            rlEnd();
+        }
+        rlSetTexture(0);
+    }
+}
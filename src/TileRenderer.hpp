@@ -0,0 +1,25 @@
+#pragma once
+#include "TileBatcher.hpp"
+#include <raylib.h>
+#include <span>
+
+// Draws a tile layer with one rlgl submission per atlas page instead of one
+// DrawTextureQuad per tile. Usually that is a single texture bind.
+class TileRenderer {
+
+  public:
+    TileRenderer() = default;
+    TileRenderer(const BakedLevel &level, const TileAtlas &atlas)
+        : batcher(level, atlas) {}
+
+    // textures must be indexed like TileAtlas::pages().
+    void draw(const TileLayer &layer, TileRect rect,
+              std::span<const Texture2D> textures);
+
+    // draw() in two steps; prepare() returns the number of quads to submit.
+    size_t prepare(const TileLayer &layer, TileRect rect);
+    void submit(std::span<const Texture2D> textures);
+
+  private:
+    TileBatcher batcher;
+};
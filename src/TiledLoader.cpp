@@ -0,0 +1,485 @@
+#include "TiledLoader.hpp"
+#include "JsonReader.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+namespace {
+
+using Token = JsonReader::Token;
+
+bool fitsInt(double number) {
+    return number >= std::numeric_limits<int>::min() &&
+           number <= std::numeric_limits<int>::max();
+}
+
+// Counts, sizes and ids: anything but a whole number that fits an int is an
+// error.
+bool readInt(JsonReader &reader, int &value) {
+    if (reader.next() != Token::Number) {
+        return false;
+    }
+    double number = reader.number();
+    if (!fitsInt(number) || std::trunc(number) != number) {
+        return false;
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+// Object positions and sizes may have fractions; they are truncated, like
+// tson's get<int>().
+bool readCoordinate(JsonReader &reader, int &value) {
+    if (reader.next() != Token::Number || !fitsInt(reader.number())) {
+        return false;
+    }
+    value = static_cast<int>(reader.number());
+    return true;
+}
+
+bool readBool(JsonReader &reader, bool &value) {
+    Token token = reader.next();
+    value = token == Token::True;
+    return token == Token::True || token == Token::False;
+}
+
+bool readString(JsonReader &reader, std::string &value) {
+    if (reader.next() != Token::String) {
+        return false;
+    }
+    value = reader.text();
+    return true;
+}
+
+// Calls fn(key) for every member of the object that starts with first. fn
+// consumes the value and returns false to stop with an error.
+template <typename Fn>
+bool forEachMember(JsonReader &reader, Token first, Fn &&fn) {
+    if (first != Token::BeginObject) {
+        return false;
+    }
+    std::string key;
+    while (true) {
+        Token token = reader.next();
+        if (token == Token::EndObject) {
+            return true;
+        }
+        if (token != Token::Key) {
+            return false;
+        }
+        key = reader.text();
+        if (!fn(key)) {
+            return false;
+        }
+    }
+}
+
+// Calls fn(token) with the first token of every element of the array that
+// starts with first.
+template <typename Fn>
+bool forEachElement(JsonReader &reader, Token first, Fn &&fn) {
+    if (first != Token::BeginArray) {
+        return false;
+    }
+    while (true) {
+        Token token = reader.next();
+        if (token == Token::EndArray) {
+            return true;
+        }
+        if (!fn(token)) {
+            return false;
+        }
+    }
+}
+
+bool skipValue(JsonReader &reader) { return reader.skip(reader.next()); }
+
+struct ParsedObject {
+    LevelData::Object object;
+    bool rectangle = true; // Tiled has no explicit rectangle flag
+};
+
+bool readObject(JsonReader &reader, Token first, ParsedObject &parsed) {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    bool ok = forEachMember(reader, first, [&](const std::string &key) {
+        if (key == "name") {
+            return readString(reader, parsed.object.name);
+        }
+        if (key == "type") {
+            return readString(reader, parsed.object.type);
+        }
+        if (key == "x") {
+            return readCoordinate(reader, x);
+        }
+        if (key == "y") {
+            return readCoordinate(reader, y);
+        }
+        if (key == "width") {
+            return readCoordinate(reader, width);
+        }
+        if (key == "height") {
+            return readCoordinate(reader, height);
+        }
+        if (key == "ellipse" || key == "point") {
+            bool set = false;
+            if (!readBool(reader, set)) {
+                return false;
+            }
+            parsed.rectangle = parsed.rectangle && !set;
+            return true;
+        }
+        if (key == "polygon" || key == "polyline" || key == "text" ||
+            key == "gid" || key == "template") {
+            parsed.rectangle = false;
+        }
+        return skipValue(reader);
+    });
+    parsed.object.bounds = {static_cast<float>(x), static_cast<float>(y),
+                            static_cast<float>(width),
+                            static_cast<float>(height)};
+    return ok;
+}
+
+bool readObjects(JsonReader &reader, std::vector<ParsedObject> &objects) {
+    return forEachElement(reader, reader.next(), [&](Token token) {
+        ParsedObject parsed;
+        if (!readObject(reader, token, parsed)) {
+            return false;
+        }
+        objects.push_back(std::move(parsed));
+        return true;
+    });
+}
+
+struct ParsedTile {
+    int id = 0;
+    bool hasType = false;
+    std::string type;
+    std::string className;
+    std::vector<baked::Rect> shapes;
+};
+
+struct ParsedTileset {
+    int firstGid = 0;
+    int tileCount = 0;
+    int columns = 0;
+    int tileWidth = 0;
+    int tileHeight = 0;
+    int margin = 0;
+    int spacing = 0;
+    int imageWidth = 0;
+    int imageHeight = 0;
+    std::string image;
+    std::vector<ParsedTile> tiles;
+};
+
+bool readTile(JsonReader &reader, Token first, ParsedTile &tile) {
+    return forEachMember(reader, first, [&](const std::string &key) {
+        if (key == "id") {
+            return readInt(reader, tile.id);
+        }
+        if (key == "type") {
+            tile.hasType = true;
+            return readString(reader, tile.type);
+        }
+        if (key == "class") {
+            // Tiled 1.9 called it class
+            return readString(reader, tile.className);
+        }
+        if (key != "objectgroup") {
+            return skipValue(reader);
+        }
+        return forEachMember(
+            reader, reader.next(), [&](const std::string &groupKey) {
+                if (groupKey != "objects") {
+                    return skipValue(reader);
+                }
+                std::vector<ParsedObject> objects;
+                if (!readObjects(reader, objects)) {
+                    return false;
+                }
+                for (const ParsedObject &parsed : objects) {
+                    if (parsed.rectangle) {
+                        tile.shapes.push_back(parsed.object.bounds);
+                    }
+                }
+                return true;
+            });
+    });
+}
+
+bool readTileset(JsonReader &reader, Token first, ParsedTileset &tileset) {
+    return forEachMember(reader, first, [&](const std::string &key) {
+        if (key == "firstgid") {
+            return readInt(reader, tileset.firstGid);
+        }
+        if (key == "tilecount") {
+            return readInt(reader, tileset.tileCount);
+        }
+        if (key == "columns") {
+            return readInt(reader, tileset.columns);
+        }
+        if (key == "tilewidth") {
+            return readInt(reader, tileset.tileWidth);
+        }
+        if (key == "tileheight") {
+            return readInt(reader, tileset.tileHeight);
+        }
+        if (key == "margin") {
+            return readInt(reader, tileset.margin);
+        }
+        if (key == "spacing") {
+            return readInt(reader, tileset.spacing);
+        }
+        if (key == "imagewidth") {
+            return readInt(reader, tileset.imageWidth);
+        }
+        if (key == "imageheight") {
+            return readInt(reader, tileset.imageHeight);
+        }
+        if (key == "image") {
+            return readString(reader, tileset.image);
+        }
+        if (key == "source") {
+            return false; // External tileset
+        }
+        if (key == "tiles") {
+            return forEachElement(reader, reader.next(), [&](Token token) {
+                tileset.tiles.emplace_back();
+                return readTile(reader, token, tileset.tiles.back());
+            });
+        }
+        return skipValue(reader);
+    });
+}
+
+struct ParsedLayer {
+    std::string name;
+    int width = 0;
+    int height = 0;
+    std::string encoding;
+    std::string compression;
+    std::string encodedData;
+    std::vector<uint32_t> data;
+    std::vector<ParsedObject> objects;
+};
+
+bool readData(JsonReader &reader, ParsedLayer &layer) {
+    Token first = reader.next();
+    if (first == Token::String) {
+        // Decoded once the whole layer, with its encoding, has been read
+        layer.encodedData = reader.text();
+        return true;
+    }
+    std::vector<uint32_t> &data = layer.data;
+    return forEachElement(reader, first, [&](Token token) {
+        if (token != Token::Number) {
+            return false;
+        }
+        uint32_t cell;
+        if (!reader.uint32(cell)) {
+            cell = static_cast<uint32_t>(reader.number());
+        }
+        data.push_back(cell);
+        return true;
+    });
+}
+
+bool readLayer(JsonReader &reader, Token first,
+               tson::DecompressorContainer &decompressors,
+               ParsedLayer &layer) {
+    bool ok = forEachMember(reader, first, [&](const std::string &key) {
+        if (key == "name") {
+            return readString(reader, layer.name);
+        }
+        if (key == "width") {
+            return readInt(reader, layer.width);
+        }
+        if (key == "height") {
+            return readInt(reader, layer.height);
+        }
+        if (key == "encoding") {
+            return readString(reader, layer.encoding);
+        }
+        if (key == "compression") {
+            return readString(reader, layer.compression);
+        }
+        if (key == "data") {
+            return readData(reader, layer);
+        }
+        if (key == "objects") {
+            return readObjects(reader, layer.objects);
+        }
+        if (key == "chunks") {
+            return false; // Infinite map
+        }
+        return skipValue(reader);
+    });
+    if (!ok || layer.encodedData.empty()) {
+        return ok;
+    }
+    size_t count = static_cast<size_t>(std::max(layer.width, 0)) *
+                   static_cast<size_t>(std::max(layer.height, 0));
+    return decompressors.decodeTileData(layer.encodedData, layer.encoding,
+                                        layer.compression, count, layer.data);
+}
+
+// The first layer with each name wins, like tson::Map::getLayer().
+struct NamedLayers {
+    bool hasTiles = false;
+    bool hasColliders = false;
+    bool hasObjects = false;
+    std::vector<uint32_t> tiles;
+    std::vector<ParsedObject> colliders;
+    std::vector<ParsedObject> objects;
+
+    void add(ParsedLayer &layer) {
+        if (!hasTiles && layer.name == TILE_LAYER_NAME) {
+            hasTiles = true;
+            tiles = std::move(layer.data);
+        } else if (!hasColliders && layer.name == COLLIDER_LAYER_NAME) {
+            hasColliders = true;
+            colliders = std::move(layer.objects);
+        } else if (!hasObjects && layer.name == OBJECT_LAYER_NAME) {
+            hasObjects = true;
+            objects = std::move(layer.objects);
+        }
+    }
+};
+
+// Mirrors extractLevel(), including the order in which tileson lists the
+// tiles of a tileset: the ones from the file first, then one without shapes
+// for every remaining gid. Fails for tilesets whose gids do not fit.
+bool buildTiles(LevelData &level, const std::vector<ParsedTileset> &tilesets) {
+    uint32_t gidCount = 1;
+    for (const ParsedTileset &tileset : tilesets) {
+        if (!validGidRange(tileset.firstGid, tileset.tileCount)) {
+            return false;
+        }
+        gidCount = std::max(gidCount, static_cast<uint32_t>(
+                                          tileset.firstGid +
+                                          tileset.tileCount));
+    }
+    level.tiles.resize(gidCount, baked::Tile{});
+
+    for (const ParsedTileset &tileset : tilesets) {
+        auto tilesetIndex = static_cast<uint32_t>(level.tilesets.size());
+        auto firstGid = static_cast<uint32_t>(tileset.firstGid);
+        level.tilesets.push_back({firstGid,
+                                  static_cast<uint32_t>(tileset.tileCount),
+                                  tileset.imageWidth, tileset.imageHeight,
+                                  tileset.image});
+
+        for (int local = 0; local < tileset.tileCount; ++local) {
+            baked::Tile &tile = level.tiles[firstGid + local];
+            tile.tileset = tilesetIndex;
+            tile.source = tileSource(local, tileset.columns, tileset.tileWidth,
+                                     tileset.tileHeight, tileset.margin,
+                                     tileset.spacing);
+        }
+
+        std::vector<uint8_t> listed(tileset.tileCount, 0);
+        for (const ParsedTile &parsed : tileset.tiles) {
+            uint32_t gid = firstGid + static_cast<uint32_t>(parsed.id);
+            if (parsed.id >= 0 && parsed.id < tileset.tileCount) {
+                listed[parsed.id] = 1;
+            }
+            if (gid >= level.tiles.size()) {
+                continue;
+            }
+            baked::Tile &tile = level.tiles[gid];
+            tile.firstShape = static_cast<uint32_t>(level.tileShapes.size());
+            level.tileShapes.insert(level.tileShapes.end(),
+                                    parsed.shapes.begin(), parsed.shapes.end());
+            tile.shapeCount = static_cast<uint32_t>(parsed.shapes.size());
+            tile.collision = tileCollision(
+                parsed.hasType ? parsed.type : parsed.className,
+                tile.shapeCount);
+        }
+        for (int local = 0; local < tileset.tileCount; ++local) {
+            if (!listed[local]) {
+                baked::Tile &tile = level.tiles[firstGid + local];
+                tile.firstShape =
+                    static_cast<uint32_t>(level.tileShapes.size());
+                tile.shapeCount = 0;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool loadTiledLevel(std::istream &in, LevelData &level,
+                    tson::DecompressorContainer &decompressors) {
+    JsonReader reader(in);
+    std::vector<ParsedTileset> tilesets;
+    NamedLayers layers;
+    level = LevelData{};
+
+    bool ok = forEachMember(reader, reader.next(), [&](const std::string &key) {
+        if (key == "width") {
+            return readInt(reader, level.width);
+        }
+        if (key == "height") {
+            return readInt(reader, level.height);
+        }
+        if (key == "tilewidth") {
+            return readInt(reader, level.tileWidth);
+        }
+        if (key == "tileheight") {
+            return readInt(reader, level.tileHeight);
+        }
+        if (key == "infinite") {
+            bool infinite = false;
+            return readBool(reader, infinite) && !infinite;
+        }
+        if (key == "tilesets") {
+            return forEachElement(reader, reader.next(), [&](Token token) {
+                tilesets.emplace_back();
+                return readTileset(reader, token, tilesets.back());
+            });
+        }
+        if (key == "layers") {
+            // Layers are parsed one at a time; only the ones the game uses
+            // are kept.
+            return forEachElement(reader, reader.next(), [&](Token token) {
+                ParsedLayer layer;
+                if (!readLayer(reader, token, decompressors, layer)) {
+                    return false;
+                }
+                layers.add(layer);
+                return true;
+            });
+        }
+        return skipValue(reader);
+    });
+    if (!ok || reader.next() != Token::End || level.width <= 0 ||
+        level.height <= 0 || !buildTiles(level, tilesets)) {
+        return false;
+    }
+
+    level.grid.assign(static_cast<size_t>(level.width) * level.height, 0);
+    std::copy_n(layers.tiles.begin(),
+                std::min(layers.tiles.size(), level.grid.size()),
+                level.grid.begin());
+
+    for (const ParsedObject &collider : layers.colliders) {
+        level.colliders.push_back(collider.object.bounds);
+    }
+    for (ParsedObject &object : layers.objects) {
+        level.objects.push_back(std::move(object.object));
+    }
+    return true;
+}
+
+bool loadTiledLevel(const std::filesystem::path &json, LevelData &level,
+                    tson::DecompressorContainer &decompressors) {
+    std::ifstream in(json, std::ios::binary);
+    return in && loadTiledLevel(in, level, decompressors);
+}
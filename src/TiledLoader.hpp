@@ -0,0 +1,17 @@
+#pragma once
+#include "LevelBaker.hpp"
+#include <filesystem>
+#include <istream>
+
+// Reads a Tiled JSON map straight into LevelData in one streaming pass,
+// without building a JSON DOM or a tson::Map, so peak memory stays close to
+// the size of the level itself. The result matches extractLevel().
+//
+// Encoded layer data is decoded with the given decompressors, as tileson
+// would. Returns false for malformed input and for features this loader does
+// not handle: external tilesets, infinite maps and encodings or compressions
+// without a matching decompressor. Callers fall back to tileson in that case.
+bool loadTiledLevel(std::istream &in, LevelData &level,
+                    tson::DecompressorContainer &decompressors);
+bool loadTiledLevel(const std::filesystem::path &json, LevelData &level,
+                    tson::DecompressorContainer &decompressors);
@@ -0,0 +1,34 @@
+#include "LevelBaker.hpp"
+#include <cstdio>
+#include <exception>
+#include <fstream>
+
+int main(int argc, const char **argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <level.json> <level.bin>\n", argv[0]);
+        return 1;
+    }
+
+    tson::Tileson tileson;
+    std::vector<std::byte> bytes;
+    try {
+        bytes = bakeLevel(tileson, argv[1]);
+    } catch (const std::exception &e) {
+        // A level too large to hold in memory, for instance
+        std::fprintf(stderr, "%s: %s\n", argv[1], e.what());
+        return 1;
+    }
+    if (bytes.empty()) {
+        std::fprintf(stderr, "failed to parse %s\n", argv[1]);
+        return 1;
+    }
+
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(bytes.data()),
+              static_cast<std::streamsize>(bytes.size()));
+    if (!out) {
+        std::fprintf(stderr, "failed to write %s\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,406 @@
+#include "HitboxCollider.hpp"
+#include "LevelGenerator.hpp"
+#include "MapLevel.hpp"
+#include "TileBatcher.hpp"
+#include "TileLayer.hpp"
+#include "TiledLoader.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Micro benchmarks for the loading, simulation and render preparation paths.
+// Every case runs a number of warm-up iterations that are thrown away, then
+// times each repeat on its own so the report can include percentiles.
+//
+//   platformer-bench [--warmup N] [--repeats N] [--format json|csv] [res]
+
+namespace {
+
+struct Options {
+    int warmup = 3;
+    int repeats = 20;
+    bool csv = false;
+    std::filesystem::path resources = "./res";
+};
+
+struct Result {
+    std::string name;
+    std::vector<double> samples; // Milliseconds, sorted
+};
+
+double percentile(const std::vector<double> &sorted, double p) {
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+// Times fn once per repeat, after options.warmup untimed calls.
+Result measure(const Options &options, std::string name,
+               const std::function<void()> &fn) {
+    for (int i = 0; i < options.warmup; ++i) {
+        fn();
+    }
+
+    Result result{std::move(name), {}};
+    result.samples.reserve(options.repeats);
+    for (int i = 0; i < options.repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        std::chrono::duration<double, std::milli> elapsed =
+            std::chrono::steady_clock::now() - start;
+        result.samples.push_back(elapsed.count());
+    }
+    std::sort(result.samples.begin(), result.samples.end());
+    std::fprintf(stderr, "%-32s p50 %10.4f ms\n", result.name.c_str(),
+                 percentile(result.samples, 0.5));
+    return result;
+}
+
+// A copy of the resources in a fresh temporary directory, so loading a
+// MapLevel can rebake and rewrite level.bin without touching the original.
+// Empty if the copy failed.
+std::filesystem::path copyResources(const std::filesystem::path &resources) {
+    std::error_code error;
+    std::filesystem::path copy = std::filesystem::temp_directory_path(error);
+    copy /= "platformer-bench-" + std::to_string(std::random_device()());
+    std::filesystem::copy(resources, copy,
+                          std::filesystem::copy_options::recursive, error);
+    if (error) {
+        std::filesystem::remove_all(copy, error);
+        return {};
+    }
+    return copy;
+}
+
+// Drops count dynamic boxes, the size of the player, in a grid above the
+// floor of the level. They never sleep, so every step simulates all of them
+// rather than a pile that came to rest during the warm-up.
+void addBodies(MapLevel &map, int count) {
+    const int columns = std::max(1, map.tileLayer.width() - 2);
+    b2PolygonShape box;
+    box.SetAsBox(0.5f, 0.5f);
+    for (int i = 0; i < count; ++i) {
+        b2BodyDef bodyDef;
+        bodyDef.type = b2_dynamicBody;
+        bodyDef.fixedRotation = true;
+        bodyDef.allowSleep = false;
+        bodyDef.position.Set(1.5f + static_cast<float>(i % columns),
+                             1.5f + static_cast<float>(i / columns) * 1.5f);
+        b2Body *body = map.world.CreateBody(&bodyDef);
+        b2FixtureDef fixtureDef;
+        fixtureDef.shape = &box;
+        fixtureDef.density = 1.0f;
+        body->CreateFixture(&fixtureDef);
+    }
+}
+
+// The byte-at-a-time decoder tileson used before, kept as the baseline for
+// the base64 cases: a branchy character lookup, a std::string result, then
+// two more copies on the way to tile ids.
+std::vector<uint32_t> referenceBase64Decode(std::string_view s) {
+    auto valueOf = [](unsigned char c) -> unsigned int {
+        if (c >= 'A' && c <= 'Z') {
+            return c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            return c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            return c - '0' + 52;
+        }
+        return c == '+' || c == '-' ? 62 : 63;
+    };
+    std::string decoded;
+    decoded.reserve(s.size() / 4 * 3);
+    for (size_t pos = 0; pos + 3 < s.size(); pos += 4) {
+        unsigned int second = valueOf(s[pos + 1]);
+        decoded.push_back(static_cast<char>((valueOf(s[pos]) << 2) +
+                                            ((second & 0x30) >> 4)));
+        if (s[pos + 2] != '=') {
+            unsigned int third = valueOf(s[pos + 2]);
+            decoded.push_back(static_cast<char>(((second & 0x0f) << 4) +
+                                                ((third & 0x3c) >> 2)));
+            if (s[pos + 3] != '=') {
+                decoded.push_back(static_cast<char>(((third & 0x03) << 6) +
+                                                    valueOf(s[pos + 3])));
+            }
+        }
+    }
+    std::vector<uint8_t> bytes;
+    for (char c : decoded) {
+        bytes.push_back(static_cast<uint8_t>(c));
+    }
+    std::vector<uint32_t> ids;
+    for (size_t i = 0; i + 3 < bytes.size(); i += 4) {
+        ids.push_back(static_cast<uint32_t>(bytes[i + 3]) << 24 |
+                      static_cast<uint32_t>(bytes[i + 2]) << 16 |
+                      static_cast<uint32_t>(bytes[i + 1]) << 8 | bytes[i]);
+    }
+    return ids;
+}
+
+void printJson(const Options &options, const std::vector<Result> &results) {
+    std::printf("{\n  \"warmup\": %d,\n  \"repeats\": %d,\n  \"results\": [\n",
+                options.warmup, options.repeats);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const std::vector<double> &s = results[i].samples;
+        double mean = std::accumulate(s.begin(), s.end(), 0.0) / s.size();
+        std::printf("    {\"name\": \"%s\", \"unit\": \"ms\", "
+                    "\"min\": %.6f, \"mean\": %.6f, \"p50\": %.6f, "
+                    "\"p90\": %.6f, \"p99\": %.6f, \"max\": %.6f}%s\n",
+                    results[i].name.c_str(), s.front(), mean,
+                    percentile(s, 0.5), percentile(s, 0.9),
+                    percentile(s, 0.99), s.back(),
+                    i + 1 < results.size() ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+}
+
+void printCsv(const std::vector<Result> &results) {
+    std::printf("name,unit,min,mean,p50,p90,p99,max\n");
+    for (const Result &result : results) {
+        const std::vector<double> &s = result.samples;
+        double mean = std::accumulate(s.begin(), s.end(), 0.0) / s.size();
+        std::printf("%s,ms,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+                    result.name.c_str(), s.front(), mean, percentile(s, 0.5),
+                    percentile(s, 0.9), percentile(s, 0.99), s.back());
+    }
+}
+
+} // namespace
+
+int main(int argc, const char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            options.warmup = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+            options.repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            options.csv = std::strcmp(argv[++i], "csv") == 0;
+        } else if (argv[i][0] != '-') {
+            options.resources = argv[i];
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--warmup N] [--repeats N] "
+                         "[--format json|csv] [res]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Result> results;
+    tson::Tileson tileson;
+
+    const std::filesystem::path json = options.resources / "level.json";
+    results.push_back(measure(options, "parse/level.json", [&] {
+        std::unique_ptr<tson::Map> map = tileson.parse(json);
+    }));
+    results.push_back(measure(options, "stream/level.json", [&] {
+        LevelData level;
+        loadTiledLevel(json, level, *tileson.decompressors());
+    }));
+
+    for (int size : {64, 256, 1024}) {
+        std::ostringstream out;
+        GeneratorOptions generator;
+        generator.width = size;
+        generator.height = size;
+        writeTiledJson(generateLevel(generator), out);
+        const std::string data = out.str();
+        std::string name = "synthetic-" + std::to_string(size) + "x" +
+                           std::to_string(size);
+        results.push_back(measure(options, "parse/" + name, [&] {
+            std::unique_ptr<tson::Map> map =
+                tileson.parse(data.data(), data.size());
+        }));
+        results.push_back(measure(options, "stream/" + name, [&] {
+            std::istringstream in(data);
+            LevelData level;
+            loadTiledLevel(in, level, *tileson.decompressors());
+        }));
+    }
+
+    // A 1024x1024 tile layer is 4 MiB of ids, 5.3 MiB as base64.
+    {
+        std::ostringstream out;
+        GeneratorOptions generator;
+        generator.width = 1024;
+        generator.height = 1024;
+        writeTiledJson(generateLevel(generator), out, TileEncoding::Base64);
+        const std::string data = out.str();
+        results.push_back(measure(options, "parse/synthetic-base64", [&] {
+            std::unique_ptr<tson::Map> map =
+                tileson.parse(data.data(), data.size());
+        }));
+        results.push_back(measure(options, "stream/synthetic-base64", [&] {
+            std::istringstream in(data);
+            LevelData level;
+            loadTiledLevel(in, level, *tileson.decompressors());
+        }));
+
+        std::unique_ptr<tson::Map> map =
+            tileson.parse(data.data(), data.size());
+        const std::string encoded =
+            map->getLayer(TILE_LAYER_NAME)->getBase64Data();
+        results.push_back(measure(options, "base64/reference", [&] {
+            std::vector<uint32_t> ids = referenceBase64Decode(encoded);
+        }));
+        results.push_back(measure(options, "base64/decode", [&] {
+            std::vector<uint32_t> ids(
+                tson::Base64Decompressor::decodedSize(encoded) / 4);
+            tson::Base64Decompressor::decode(
+                encoded, reinterpret_cast<uint8_t *>(ids.data()));
+        }));
+    }
+
+    const std::pair<TileCompression, const char *> compressions[] = {
+        {TileCompression::Zlib, "zlib"},
+        {TileCompression::Gzip, "gzip"},
+        {TileCompression::Zstd, "zstd"}};
+    for (auto [compression, suffix] : compressions) {
+        if (!compressionSupported(compression)) {
+            continue;
+        }
+        std::ostringstream out;
+        GeneratorOptions generator;
+        generator.width = 1024;
+        generator.height = 1024;
+        writeTiledJson(generateLevel(generator), out, TileEncoding::Base64,
+                       compression);
+        const std::string data = out.str();
+        std::string name = std::string("synthetic-") + suffix;
+        results.push_back(measure(options, "parse/" + name, [&] {
+            std::unique_ptr<tson::Map> map =
+                tileson.parse(data.data(), data.size());
+        }));
+        results.push_back(measure(options, "stream/" + name, [&] {
+            std::istringstream in(data);
+            LevelData level;
+            loadTiledLevel(in, level, *tileson.decompressors());
+        }));
+    }
+
+    // Everything that builds a MapLevel works on a copy, since a stale
+    // level.bin gets rebaked and rewritten on load.
+    const std::filesystem::path resources = copyResources(options.resources);
+    if (resources.empty() || !MapLevel(tileson, resources).level.isOpen()) {
+        std::fprintf(stderr, "Failed to load the level from %s\n",
+                     options.resources.string().c_str());
+        std::error_code error;
+        std::filesystem::remove_all(resources, error);
+        return 1;
+    }
+    results.push_back(measure(options, "load/MapLevel", [&] {
+        MapLevel map(tileson, resources);
+    }));
+
+    // The Box2D world on its own, then a whole simulation step: activity
+    // regions, characters and the world.
+    for (int bodies : {0, 100, 1000}) {
+        MapLevel map(tileson, resources);
+        addBodies(map, bodies);
+        std::string name = "step/" + std::to_string(bodies) + "-bodies";
+        results.push_back(measure(options, name, [&] {
+            map.world.Step(TIME_STEP, 6, 2);
+        }));
+    }
+    for (int bodies : {0, 1000}) {
+        MapLevel map(tileson, resources);
+        addBodies(map, bodies);
+        std::string name =
+            "step/MapLevel-" + std::to_string(bodies) + "-bodies";
+        results.push_back(measure(options, name, [&] {
+            map.step(PlayerInput{});
+        }));
+    }
+
+    // A wide generated level crowded with enemy characters and props, with
+    // the activity regions as they are, then with everything awake at full
+    // rate.
+    {
+        const std::filesystem::path crowd = resources / "crowd";
+        GeneratorOptions generator;
+        generator.width = 1024;
+        generator.height = 128;
+        generator.objects = 2000;
+        generator.props = 1000;
+        std::error_code error;
+        std::filesystem::create_directories(crowd, error);
+        std::ofstream out(crowd / "level.json");
+        writeTiledJson(generateLevel(generator), out);
+        out.close();
+        for (bool regions : {true, false}) {
+            MapLevel map(tileson, crowd);
+            if (!map.level.isOpen()) {
+                break;
+            }
+            if (!regions) {
+                constexpr float EVERYWHERE =
+                    std::numeric_limits<float>::infinity();
+                map.activity.fullRateRadius = EVERYWHERE;
+                map.activity.halfRateRadius = EVERYWHERE;
+                map.activity.radius = EVERYWHERE;
+            }
+            // Past the first drop, once the crowd has come to rest
+            for (int i = 0; i < 120; ++i) {
+                map.step(PlayerInput{});
+            }
+            results.push_back(measure(
+                options, regions ? "step/crowd" : "step/crowd-all-active",
+                [&] { map.step(PlayerInput{}); }));
+        }
+    }
+
+    // Bullet-sized boxes scattered over the whole map.
+    for (int boxes : {1000, 10000, 100000}) {
+        MapLevel map(tileson, resources);
+        const CollisionGrid &grid = map.collisionGrid;
+        std::mt19937 random(1);
+        std::uniform_real_distribution<float> x(
+            0.0f, static_cast<float>(grid.width() * grid.tileWidth()));
+        std::uniform_real_distribution<float> y(
+            0.0f, static_cast<float>(grid.height() * grid.tileHeight()));
+        HitboxBatch batch;
+        for (int i = 0; i < boxes; ++i) {
+            batch.add(x(random), y(random), {-2.0f, -2.0f, 4.0f, 4.0f});
+        }
+        HitboxPushes pushes;
+        std::string name = "collide/" + std::to_string(boxes) + "-hitboxes";
+        results.push_back(measure(options, name, [&] {
+            collideHitboxes(grid, batch, pushes);
+        }));
+    }
+
+    // The culling and batching work of one rendered frame: an 800x450 window
+    // at zoom 3, and the whole map as the worst case.
+    MapLevel map(tileson, resources);
+    TileBatcher batcher(map.level, TileAtlas(map.level));
+    results.push_back(measure(options, "render-prep/view", [&] {
+        TileRect rect = map.tileLayer.cellsCovering(0.0f, 0.0f, 800.0f / 3.0f,
+                                                    450.0f / 3.0f);
+        batcher.build(map.tileLayer, rect);
+    }));
+    results.push_back(measure(options, "render-prep/full-map", [&] {
+        batcher.build(map.tileLayer, {0, 0, map.tileLayer.width(),
+                                      map.tileLayer.height()});
+    }));
+
+    std::error_code error;
+    std::filesystem::remove_all(resources, error);
+
+    if (options.csv) {
+        printCsv(results);
+    } else {
+        printJson(options, results);
+    }
+    return 0;
+}
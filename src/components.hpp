@@ -1,6 +1,12 @@
 #pragma once
 
 #include "box2d/b2_body.h"
+
+// Box2D works in metres; a metre is one 16 pixel tile.
+constexpr float BOX2D_SCALE = 1.0f / 16.0f;
+constexpr float toBox2D(float px) { return px * BOX2D_SCALE; }
+constexpr float fromBox2D(float m) { return m / BOX2D_SCALE; }
+
 struct PhysicsComponent {
     float x;
     float y;
@@ -8,9 +14,12 @@ struct PhysicsComponent {
     float yVelocity;
     float xVelocity;
 
+    // Kept up to date by GroundContactListener for bodies with a foot
+    // sensor; copied from CharacterComponent::onGround for characters.
     bool isOnGround;
 
-    b2Body *body;
+    b2Body *body; // Null for characters, see CharacterComponent
+    b2Vec2 previousPosition; // Body position before the last step
 };
 
 struct HitboxComponent {
@@ -21,6 +30,47 @@ struct HitboxComponent {
 };
 
 struct PlayerComponent {
-    double lastJump = -1.0;
-    double lastGrounded = -1.0;
+    double lastJump = -1.0;     // Simulation time, see MapLevel::time
+    double lastGrounded = -1.0; // Last step that began on the ground
+};
+
+// A character moved by moveCharacter() over the tile collision grid instead
+// of by Box2D. Everything the controller needs is in here, so moving many
+// characters walks a single dense array. Positions are the centre of the
+// bottom edge of the box, in pixels.
+struct CharacterComponent {
+    float x;
+    float y;
+    float previousX; // Position before the last step
+    float previousY;
+    float xVelocity; // Pixels per second
+    float yVelocity;
+    float halfWidth;
+    float height;
+    float stepHeight; // Tallest ledge it walks up without jumping
+    bool onGround;
+    bool dropDown; // Falls through one-way cells on the next step
+};
+
+// Set on entities outside every activity region. The simulation skips them
+// and their body is disabled; see ActivityRegions.
+struct DormantComponent {};
+
+// How often an awake entity is simulated, set by ActivityRegions from its
+// distance to the players and the camera.
+struct TickRateComponent {
+    uint32_t interval; // Steps between two updates: 1, 2 or 4
+    uint32_t lastStep; // Step it last ran on
+};
+
+// Keeps an entity awake, wherever it is, until the given simulation time.
+struct KeepAwakeComponent {
+    double until;
+};
+
+// Number of contacts between the foot sensor of an entity and solid
+// fixtures. A count rather than a flag: the level's chain shapes make one
+// contact per edge, and a sensor often spans two edges.
+struct GroundSensorComponent {
+    int contacts = 0;
 };
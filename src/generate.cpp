@@ -0,0 +1,105 @@
+#include "LevelGenerator.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+// Writes a generated level as Tiled JSON (*.json) or baked (anything else).
+//
+//   platformer-generate [--width N] [--height N] [--density F]
+//                       [--colliders N] [--objects N] [--props N]
+//                       [--tilesets N] [--seed N] [--encoding csv|base64]
+//                       [--compression zlib|gzip|zstd] <output>
+
+// Tiled's names for the layer compressions.
+static bool parseCompression(const char *name, TileCompression &compression) {
+    if (std::strcmp(name, "zlib") == 0) {
+        compression = TileCompression::Zlib;
+    } else if (std::strcmp(name, "gzip") == 0) {
+        compression = TileCompression::Gzip;
+    } else if (std::strcmp(name, "zstd") == 0) {
+        compression = TileCompression::Zstd;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, const char **argv) {
+    GeneratorOptions options;
+    TileEncoding encoding = TileEncoding::Csv;
+    TileCompression compression = TileCompression::None;
+    const char *output = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (arg[0] != '-') {
+            output = arg;
+            continue;
+        }
+        if (value == nullptr) {
+            output = nullptr;
+            break;
+        }
+        ++i;
+        if (std::strcmp(arg, "--width") == 0) {
+            options.width = std::atoi(value);
+        } else if (std::strcmp(arg, "--height") == 0) {
+            options.height = std::atoi(value);
+        } else if (std::strcmp(arg, "--density") == 0) {
+            options.density = static_cast<float>(std::atof(value));
+        } else if (std::strcmp(arg, "--colliders") == 0) {
+            options.colliders = std::atoi(value);
+        } else if (std::strcmp(arg, "--objects") == 0) {
+            options.objects = std::atoi(value);
+        } else if (std::strcmp(arg, "--props") == 0) {
+            options.props = std::atoi(value);
+        } else if (std::strcmp(arg, "--tilesets") == 0) {
+            options.tilesets = std::atoi(value);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--compression") == 0) {
+            if (!parseCompression(value, compression)) {
+                output = nullptr;
+                break;
+            }
+        } else if (std::strcmp(arg, "--encoding") == 0) {
+            encoding = std::strcmp(value, "base64") == 0 ? TileEncoding::Base64
+                                                         : TileEncoding::Csv;
+        } else {
+            output = nullptr;
+            break;
+        }
+    }
+    if (output == nullptr) {
+        std::fprintf(stderr,
+                     "usage: %s [--width N] [--height N] [--density F] "
+                     "[--colliders N] [--objects N] [--props N] "
+                     "[--tilesets N] "
+                     "[--seed N] [--encoding csv|base64] "
+                     "[--compression zlib|gzip|zstd] "
+                     "<level.json|level.bin>\n",
+                     argv[0]);
+        return 1;
+    }
+    if (!compressionSupported(compression)) {
+        std::fprintf(stderr, "this build does not support that compression\n");
+        return 1;
+    }
+
+    LevelData level = generateLevel(options);
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (std::filesystem::path(output).extension() == ".json") {
+        writeTiledJson(level, out, encoding, compression);
+    } else {
+        std::vector<std::byte> bytes = writeBakedLevel(level);
+        out.write(reinterpret_cast<const char *>(bytes.data()),
+                  static_cast<std::streamsize>(bytes.size()));
+    }
+    out.flush();
+    if (!out) {
+        std::fprintf(stderr, "failed to write %s\n", output);
+        return 1;
+    }
+    return 0;
+}
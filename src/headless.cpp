@@ -0,0 +1,125 @@
+#include "MapLevel.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+
+// Runs the simulation without a window, as fast as the machine allows.
+//
+// An input script holds one "<tick> <keys>" line per change of input, where
+// keys is any combination of L, R, D (down) and J, or "-" for none. Left,
+// right and down stay held until the next line; J jumps once, on the tick of
+// its line.
+
+using InputScript = std::map<long, PlayerInput>;
+
+static bool readScript(const char *path, InputScript &script) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    long tick = 0;
+    std::string keys;
+    while (in >> tick >> keys) {
+        PlayerInput input{false, false, false, false};
+        for (char key : keys) {
+            input.left = input.left || key == 'L';
+            input.right = input.right || key == 'R';
+            input.jump = input.jump || key == 'J';
+            input.down = input.down || key == 'D';
+        }
+        script[tick] = input;
+    }
+    return in.eof();
+}
+
+int main(int argc, const char **argv) {
+    long ticks = 600;
+    const char *scriptPath = nullptr;
+    const char *resources = "./res";
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            scriptPath = argv[++i];
+        } else if (argv[i][0] != '-') {
+            resources = argv[i];
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--ticks N] [--input script] [res]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    InputScript script;
+    if (scriptPath != nullptr && !readScript(scriptPath, script)) {
+        std::fprintf(stderr, "failed to read %s\n", scriptPath);
+        return 1;
+    }
+
+    tson::Tileson tileson;
+    MapLevel map(tileson, resources);
+    if (!map.level.isOpen()) {
+        std::fprintf(stderr, "failed to load the level from %s\n", resources);
+        return 1;
+    }
+
+    PlayerInput held{false, false, false, false};
+    auto start = std::chrono::steady_clock::now();
+    for (long tick = 0; tick < ticks; ++tick) {
+        PlayerInput input{held.left, held.right, false, held.down};
+        if (auto change = script.find(tick); change != script.end()) {
+            held = change->second;
+            input = held;
+            held.jump = false;
+        }
+        map.step(input);
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    std::printf("%ld ticks in %.3f s (%.0f ticks/s)\n", ticks,
+                elapsed.count(),
+                elapsed.count() > 0.0 ? ticks / elapsed.count() : 0.0);
+    map.registry.view<const CharacterComponent, const PlayerComponent>().each(
+        [](const CharacterComponent &character, const PlayerComponent &) {
+            std::printf("player at %.3f, %.3f\n", character.x, character.y);
+        });
+    int props = 0;
+    int grounded = 0;
+    map.registry.view<const PhysicsComponent, const GroundSensorComponent>()
+        .each([&](const PhysicsComponent &physC,
+                  const GroundSensorComponent &) {
+            ++props;
+            grounded += physC.isOnGround ? 1 : 0;
+        });
+    if (props > 0) {
+        std::printf("%d of %d props on the ground\n", grounded, props);
+    }
+    // How the activity regions split up the other entities
+    int tiers[3] = {0, 0, 0};
+    int dormant = 0;
+    int others = 0;
+    map.registry.view<const PhysicsComponent>(entt::exclude<PlayerComponent>)
+        .each([&](entt::entity entity, const PhysicsComponent &) {
+            ++others;
+            if (map.registry.all_of<DormantComponent>(entity)) {
+                ++dormant;
+            } else if (const auto *rate =
+                           map.registry.try_get<TickRateComponent>(entity)) {
+                ++tiers[rate->interval >= 4 ? 2 : rate->interval - 1];
+            } else {
+                ++tiers[0];
+            }
+        });
+    if (others > 0) {
+        std::printf("%d entities: %d full rate, %d half, %d quarter, "
+                    "%d dormant\n",
+                    others, tiers[0], tiers[1], tiers[2], dormant);
+    }
+    return 0;
+}
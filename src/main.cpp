@@ -1,22 +1,47 @@
 #include <raylib.h>
-#include "tileson.hpp"
-#include "MapLevel.hpp"
+#include "LevelLoader.hpp"
+#include "LevelView.hpp"
+#include <utility>
 
 int main(int argc, const char **argv) {
+    // The simulation runs on a fixed time step, so rendering can follow the
+    // display's refresh rate.
+    SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(800, 450, "DevWindow");
 
-    SetTargetFPS(60);
-
     {
-        tson::Tileson tileson;
-        MapLevel map(tileson, "./res");
-
-        while (!WindowShouldClose()) {
+        // Large levels take seconds to load, so keep presenting frames while
+        // a worker does the loading.
+        LevelLoader loader("./res");
+        while (!loader.ready() && !WindowShouldClose()) {
             BeginDrawing();
             ClearBackground(GRAY);
-            map.frame();
+            drawLoadingScreen(loader.progress());
             EndDrawing();
         }
+
+        LoadedLevel loaded;
+        if (loader.ready()) {
+            loaded = loader.take();
+            if (!loaded.isOpen()) {
+                TraceLog(LOG_ERROR, "Failed to load the level from ./res");
+            }
+        }
+        if (loaded.isOpen()) {
+            MapLevel &map = *loaded.map;
+            LevelView view(map, loaded.atlas, std::move(loaded.pages));
+
+            while (!WindowShouldClose()) {
+                map.activity.setCamera(view.camera.target.x,
+                                       view.camera.target.y);
+                map.update(GetFrameTime(), pollInput());
+
+                BeginDrawing();
+                ClearBackground(GRAY);
+                view.draw();
+                EndDrawing();
+            }
+        }
     }
 
     CloseWindow();
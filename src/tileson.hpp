@@ -63,6 +63,7 @@
 #include <map>
 #include <memory>
 #include <initializer_list>
+#include <cstdint>
 
 #define JSON11_IS_DEFINED
 
@@ -96,6 +97,8 @@ namespace json11 {
 			// Array and object typedefs
 			typedef std::vector<Json> array;
 			typedef std::map<std::string, Json> object;
+			// Arrays of unsigned 32-bit integers are stored packed, see is_uint_array()
+			typedef std::vector<uint32_t> uint_array;
 
 			// Constructors for the various types of JSON value.
 			inline Json() noexcept;                // NUL
@@ -108,6 +111,7 @@ namespace json11 {
 			inline Json(const char * value);       // STRING
 			inline Json(const array &values);      // ARRAY
 			inline Json(array &&values);           // ARRAY
+			inline Json(uint_array &&values);      // ARRAY
 			inline Json(const object &values);     // OBJECT
 			inline Json(object &&values);          // OBJECT
 
@@ -157,6 +161,13 @@ namespace json11 {
 			// Return the enclosed std::map if this is an object, or an empty map otherwise.
 			inline const object &object_items() const;
 
+			// True for arrays that were parsed as nothing but unsigned 32-bit integers, like tile
+			// layer data. These keep their values packed; array_items() builds Json elements for
+			// them on first use.
+			inline bool is_uint_array() const;
+			// Return the packed values if is_uint_array(), or an empty vector otherwise.
+			inline const uint_array &uint_array_items() const;
+
 			// Return a reference to arr[i] if this is an array, Json() otherwise.
 			inline const Json & operator[](size_t i) const;
 			// Return a reference to obj[key] if this is an object, Json() otherwise.
@@ -224,6 +235,8 @@ namespace json11 {
 			friend class Json;
 			friend class JsonInt;
 			friend class JsonDouble;
+			friend class JsonArray;
+			friend class JsonUIntArray;
 			virtual Json::Type type() const = 0;
 			virtual bool equals(const JsonValue * other) const = 0;
 			virtual bool less(const JsonValue * other) const = 0;
@@ -233,6 +246,8 @@ namespace json11 {
 			virtual bool bool_value() const;
 			virtual const std::string &string_value() const;
 			virtual const Json::array &array_items() const;
+			virtual bool is_uint_array() const;
+			virtual const Json::uint_array &uint_array_items() const;
 			virtual const Json &operator[](size_t i) const;
 			virtual const Json::object &object_items() const;
 			virtual const Json &operator[](const std::string &key) const;
@@ -243,11 +258,14 @@ namespace json11 {
 
 /*** End of inlined file: json11.hpp ***/
 
+#include <bit>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include <limits>
+#include <mutex>
 
 namespace json11 {
 
@@ -346,6 +364,18 @@ namespace json11 {
 		out += "]";
 	}
 
+	static void dump(const Json::uint_array &values, string &out) {
+		bool first = true;
+		out += "[";
+		for (uint32_t value : values) {
+			if (!first)
+				out += ", ";
+			out += std::to_string(value);
+			first = false;
+		}
+		out += "]";
+	}
+
 	static void dump(const Json::object &values, string &out) {
 		bool first = true;
 		out += "{";
@@ -427,11 +457,30 @@ namespace json11 {
 	class JsonArray final : public Value<Json::ARRAY, Json::array> {
 			const Json::array &array_items() const override { return m_value; }
 			const Json & operator[](size_t i) const override;
+			// The other array may be packed, so compare through array_items()
+			bool equals(const JsonValue * other) const override { return m_value == other->array_items(); }
+			bool less(const JsonValue * other)   const override { return m_value <  other->array_items(); }
 		public:
 			explicit JsonArray(const Json::array &value) : Value(value) {}
 			explicit JsonArray(Json::array &&value)      : Value(move(value)) {}
 	};
 
+	class JsonUIntArray final : public Value<Json::ARRAY, Json::uint_array> {
+			const Json::array &array_items() const override;
+			bool is_uint_array() const override { return true; }
+			const Json::uint_array &uint_array_items() const override { return m_value; }
+			const Json & operator[](size_t i) const override;
+			bool equals(const JsonValue * other) const override { return array_items() == other->array_items(); }
+			bool less(const JsonValue * other)   const override { return array_items() <  other->array_items(); }
+
+			// Built on demand by array_items(), at most once even when several
+			// threads read the same parsed document.
+			mutable Json::array m_items;
+			mutable std::once_flag m_itemsBuilt;
+		public:
+			explicit JsonUIntArray(Json::uint_array &&value) : Value(move(value)) {}
+	};
+
 	class JsonObject final : public Value<Json::OBJECT, Json::object> {
 			const Json::object &object_items() const override { return m_value; }
 			const Json & operator[](const string &key) const override;
@@ -454,6 +503,7 @@ namespace json11 {
 		const std::shared_ptr<JsonValue> f = make_shared<JsonBoolean>(false);
 		const string empty_string;
 		const vector<Json> empty_vector;
+		const Json::uint_array empty_uint_vector;
 		const map<string, Json> empty_map;
 		Statics() {}
 	};
@@ -483,6 +533,7 @@ namespace json11 {
 	Json::Json(const char * value)         : m_ptr(make_shared<JsonString>(value)) {}
 	Json::Json(const Json::array &values)  : m_ptr(make_shared<JsonArray>(values)) {}
 	Json::Json(Json::array &&values)       : m_ptr(make_shared<JsonArray>(move(values))) {}
+	Json::Json(Json::uint_array &&values)  : m_ptr(make_shared<JsonUIntArray>(move(values))) {}
 	Json::Json(const Json::object &values) : m_ptr(make_shared<JsonObject>(values)) {}
 	Json::Json(Json::object &&values)      : m_ptr(make_shared<JsonObject>(move(values))) {}
 
@@ -497,6 +548,8 @@ namespace json11 {
 	inline const string & Json::string_value()               const { return m_ptr->string_value(); }
 	inline const vector<Json> & Json::array_items()          const { return m_ptr->array_items();  }
 	inline const map<string, Json> & Json::object_items()    const { return m_ptr->object_items(); }
+	inline bool Json::is_uint_array()                        const { return m_ptr->is_uint_array(); }
+	inline const Json::uint_array & Json::uint_array_items() const { return m_ptr->uint_array_items(); }
 	inline const Json & Json::operator[] (size_t i)          const { return (*m_ptr)[i];           }
 	inline const Json & Json::operator[] (const string &key) const { return (*m_ptr)[key];         }
 
@@ -505,6 +558,8 @@ namespace json11 {
 	inline bool                      JsonValue::bool_value()                const { return false; }
 	inline const string &            JsonValue::string_value()              const { return statics().empty_string; }
 	inline const vector<Json> &      JsonValue::array_items()               const { return statics().empty_vector; }
+	inline bool                      JsonValue::is_uint_array()             const { return false; }
+	inline const Json::uint_array &  JsonValue::uint_array_items()          const { return statics().empty_uint_vector; }
 	inline const map<string, Json> & JsonValue::object_items()              const { return statics().empty_map; }
 	inline const Json &              JsonValue::operator[] (size_t)         const { return static_null(); }
 	inline const Json &              JsonValue::operator[] (const string &) const { return static_null(); }
@@ -517,6 +572,23 @@ namespace json11 {
 		if (i >= m_value.size()) return static_null();
 		else return m_value[i];
 	}
+	inline const vector<Json> & JsonUIntArray::array_items() const {
+		std::call_once(m_itemsBuilt, [this] {
+			m_items.reserve(m_value.size());
+			for (uint32_t value : m_value) {
+				if (value <= static_cast<uint32_t>(std::numeric_limits<int>::max()))
+					m_items.emplace_back(static_cast<int>(value));
+				else
+					m_items.emplace_back(static_cast<double>(value));
+			}
+		});
+		return m_items;
+	}
+	inline const Json & JsonUIntArray::operator[] (size_t i) const {
+		const vector<Json> &items = array_items();
+		if (i >= items.size()) return static_null();
+		else return items[i];
+	}
 
 /* * * * * * * * * * * * * * * * * * * *
  * Comparison
@@ -844,6 +916,80 @@ namespace json11 {
 				return std::strtod(str.c_str() + start_pos, nullptr);
 			}
 
+			/* parse_uint(out)
+			 *
+			 * Parse an unsigned integer that fits into 32 bits. Consumes eight digits at a time
+			 * with SWAR arithmetic (SIMD within a 64-bit register) where the input allows it.
+			 * Returns false, with the position undefined, for anything else.
+			 */
+			bool parse_uint(uint32_t &out) {
+				const size_t start_pos = i;
+				uint64_t value = 0;
+				if constexpr (std::endian::native == std::endian::little) {
+					while (i + 8 <= str.size()) {
+						uint64_t chunk;
+						std::memcpy(&chunk, str.data() + i, 8);
+						// High bit set in every byte that is not '0'-'9'
+						const uint64_t digits = chunk - 0x3030303030303030ULL;
+						const uint64_t other = (digits | (chunk + 0x4646464646464646ULL) | chunk) & 0x8080808080808080ULL;
+						const int count = other ? std::countr_zero(other) / 8 : 8;
+						if (count == 0)
+							break;
+
+						// Move the digits to the top so they read as an eight digit number with leading
+						// zeros, then combine pairs, quads and octets of digits.
+						uint64_t v = (digits << (8 * (8 - count))) & 0x0F0F0F0F0F0F0F0FULL;
+						v = (v * 2561) >> 8;
+						v = ((v & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+						v = ((v & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+
+						static constexpr uint64_t scale[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+						value = value * scale[count] + v;
+						i += count;
+						if (value > std::numeric_limits<uint32_t>::max())
+							return false;
+						if (count < 8)
+							break;
+					}
+				}
+				while (in_range(str[i], '0', '9')) {
+					value = value * 10 + static_cast<uint64_t>(str[i] - '0');
+					i++;
+					if (value > std::numeric_limits<uint32_t>::max())
+						return false;
+				}
+
+				if (i == start_pos || (str[start_pos] == '0' && i - start_pos > 1))
+					return false;
+				out = static_cast<uint32_t>(value);
+				return true;
+			}
+
+			/* parse_uint_array(out)
+			 *
+			 * Fast path for arrays of unsigned integers, starting at the first element. Scans the
+			 * whole array into out without creating a Json per element. Returns false if anything
+			 * else shows up, and the caller parses the array again the general way.
+			 */
+			bool parse_uint_array(Json::uint_array &out) {
+				while (true) {
+					uint32_t value;
+					if (!parse_uint(value))
+						return false;
+					out.push_back(value);
+
+					consume_whitespace();
+					if (str[i] == ']') {
+						i++;
+						return true;
+					}
+					if (str[i] != ',')
+						return false;
+					i++;
+					consume_whitespace();
+				}
+			}
+
 			/* expect(str, res)
 			 *
 			 * Expect that 'str' starts at the character that was just read. If it does, advance
@@ -929,6 +1075,15 @@ namespace json11 {
 					if (ch == ']')
 						return data;
 
+					if (in_range(ch, '0', '9') && strategy == JsonParse::STANDARD) {
+						const size_t start_pos = i - 1;
+						Json::uint_array packed;
+						i = start_pos;
+						if (parse_uint_array(packed))
+							return Json(move(packed));
+						i = start_pos + 1;
+					}
+
 					while (1) {
 						i--;
 						data.push_back(parse_json(depth + 1));
@@ -1093,13 +1248,7 @@ namespace tson
 	 */
 	std::vector<uint8_t> Tools::Base64DecodedStringToBytes(std::string_view str)
 	{
-		std::vector<uint8_t> bytes;
-		for(size_t i = 0; i < str.size(); ++i)
-		{
-			uint8_t u8 = static_cast<uint8_t>(str[i]);
-			bytes.push_back(u8);
-		}
-		return bytes;
+		return std::vector<uint8_t>(str.begin(), str.end());
 	}
 
 	/*!
@@ -1109,19 +1258,11 @@ namespace tson
 	 */
 	std::vector<uint32_t> Tools::BytesToUnsignedInts(const std::vector<uint8_t> &bytes)
 	{
-		std::vector<uint32_t> uints;
-		std::vector<uint8_t> toConvert;
-		//uint32_t size8 = (compressed[55] << 24) | (compressed[56] << 16) | (compressed[57] << 8) | compressed[58]; //Should be 66000
-
-		for(size_t i = 0; i < bytes.size(); ++i)
+		std::vector<uint32_t> uints(bytes.size() / 4);
+		for(size_t i = 0; i < uints.size(); ++i)
 		{
-			toConvert.push_back(bytes[i]);
-			if(toConvert.size() == 4)
-			{
-				uint32_t u32 = (toConvert[3] << 24) | (toConvert[2] << 16) | (toConvert[1] << 8) | toConvert[0];
-				uints.push_back(u32);
-				toConvert.clear();
-			}
+			const uint8_t *b = bytes.data() + i * 4;
+			uints[i] = (uint32_t(b[3]) << 24) | (uint32_t(b[2]) << 16) | (uint32_t(b[1]) << 8) | b[0];
 		}
 
 		return uints;
@@ -1231,16 +1372,61 @@ namespace tson
 			*/
 			virtual ~IDecompressor() = default;
 	};
+
+	/*!
+	 * Implemented by decompressors that can write into a buffer owned by the caller. Used to decompress
+	 * tile layer data straight into the tile ids, see DecompressorContainer::decodeTileData()
+	 */
+	class IBufferDecompressor
+	{
+		public:
+			/*!
+			 * Decompresses input into out until either the input ends or out is full.
+			 * @param written Number of bytes written to out
+			 * @return false if the input is not valid
+			 */
+			virtual bool decompressInto(const uint8_t *input, size_t inputSize, uint8_t *out, size_t outSize, size_t &written) = 0;
+
+			virtual ~IBufferDecompressor() = default;
+	};
 }
 
 #endif //TILESON_IDECOMPRESSOR_HPP
 
 /*** End of inlined file: IDecompressor.hpp ***/
 
+#include <array>
+#include <cstdint>
 #include <string>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+	#define TSON_BASE64_X86
+	#include <immintrin.h>
+#endif
+
 namespace tson
 {
+	/*!
+	 * Maps a base64 character to its 6-bit value, or 0xff for characters that are not part of
+	 * the alphabet. Both the standard ('+', '/') and the URL-safe ('-', '_') variants are accepted.
+	 */
+	inline constexpr std::array<uint8_t, 256> BASE64_DECODE_TABLE = []
+	{
+		std::array<uint8_t, 256> table {};
+		for(auto &value : table)
+			value = 0xff;
+		for(int i = 0; i < 26; ++i)
+		{
+			table['A' + i] = static_cast<uint8_t>(i);
+			table['a' + i] = static_cast<uint8_t>(26 + i);
+		}
+		for(int i = 0; i < 10; ++i)
+			table['0' + i] = static_cast<uint8_t>(52 + i);
+		table['+'] = table['-'] = 62;
+		table['/'] = table['_'] = 63;
+		return table;
+	}();
+
 	class Base64Decompressor : public IDecompressor<std::string_view, std::string>
 	{
 		public:
@@ -1251,8 +1437,16 @@ namespace tson
 			inline std::string decompressFile(const fs::path &path) override;
 			inline std::string decompress(const void *data, size_t size) override;
 
+			[[nodiscard]] inline static size_t decodedSize(std::string_view s);
+			inline static bool decode(std::string_view s, uint8_t *out);
+
 		private:
-			inline unsigned int pos_of_char(const unsigned char chr);
+			inline static size_t unpaddedLength(std::string_view s);
+			inline static bool decodeScalar(std::string_view s, uint8_t *out);
+			#ifdef TSON_BASE64_X86
+			__attribute__((target("sse4.1"))) inline static size_t decodeSse41(std::string_view s, uint8_t *out);
+			__attribute__((target("avx2"))) inline static size_t decodeAvx2(std::string_view s, uint8_t *out);
+			#endif
 			inline static const std::string NAME = "base64";
 	};
 
@@ -1263,59 +1457,167 @@ namespace tson
 
 	std::string Base64Decompressor::decompress(const std::string_view &s)
 	{
+		std::string ret(decodedSize(s), '\0');
+		if(!decode(s, reinterpret_cast<uint8_t *>(ret.data())))
+			throw "If input is correct, this line should never be reached.";
+		return ret;
+	}
 
-		size_t length_of_string = s.length();
-		if (!length_of_string) return std::string("");
-
-		size_t in_len = length_of_string;
-		size_t pos = 0;
-
-		//
-		// The approximate length (bytes) of the decoded string might be one ore
-		// two bytes smaller, depending on the amount of trailing equal signs
-		// in the encoded string. This approximation is needed to reserve
-		// enough space in the string to be returned.
-		//
-		size_t approx_length_of_decoded_string = length_of_string / 4 * 3;
-		std::string ret;
-		ret.reserve(approx_length_of_decoded_string);
-
-		while (pos < in_len) {
-
-			unsigned int pos_of_char_1 = pos_of_char(s[pos+1] );
-
-			ret.push_back(static_cast<std::string::value_type>( ( (pos_of_char(s[pos+0]) ) << 2 ) + ( (pos_of_char_1 & 0x30 ) >> 4)));
-
-			if (s[pos+2] != '=' && s[pos+2] != '.') { // accept URL-safe base 64 strings, too, so check for '.' also.
+	/*!
+	 * Length of the input without its trailing padding. '.' is accepted as padding as well, for URL-safe strings.
+	 */
+	size_t Base64Decompressor::unpaddedLength(std::string_view s)
+	{
+		size_t length = s.size();
+		while(length > 0 && s.size() - length < 2 && (s[length - 1] == '=' || s[length - 1] == '.'))
+			--length;
+		return length;
+	}
 
-				unsigned int pos_of_char_2 = pos_of_char(s[pos+2] );
-				ret.push_back(static_cast<std::string::value_type>( (( pos_of_char_1 & 0x0f) << 4) + (( pos_of_char_2 & 0x3c) >> 2)));
+	/*!
+	 * The exact number of bytes decode() writes for valid input.
+	 */
+	size_t Base64Decompressor::decodedSize(std::string_view s)
+	{
+		size_t length = unpaddedLength(s);
+		size_t tail = length % 4;
+		return length / 4 * 3 + (tail > 1 ? tail - 1 : 0);
+	}
 
-				if (s[pos+3] != '=' && s[pos+3] != '.') {
-					ret.push_back(static_cast<std::string::value_type>( ( (pos_of_char_2 & 0x03 ) << 6 ) + pos_of_char(s[pos+3])   ));
-				}
-			}
+	/*!
+	 * Decodes s into out, which must have room for decodedSize(s) bytes. Uses AVX2 or SSE4.1 when the CPU
+	 * supports it, for the bulk of the input, and a table lookup per character for the rest.
+	 * @return false if s is not valid base64
+	 */
+	bool Base64Decompressor::decode(std::string_view s, uint8_t *out)
+	{
+		size_t done = 0;
+		#ifdef TSON_BASE64_X86
+		if(__builtin_cpu_supports("avx2"))
+			done = decodeAvx2(s, out);
+		else if(__builtin_cpu_supports("sse4.1"))
+			done = decodeSse41(s, out);
+		#endif
+		return decodeScalar(s.substr(done), out + done / 4 * 3);
+	}
 
-			pos += 4;
+	bool Base64Decompressor::decodeScalar(std::string_view s, uint8_t *out)
+	{
+		const auto *in = reinterpret_cast<const uint8_t *>(s.data());
+		const size_t length = unpaddedLength(s);
+		size_t i = 0;
+		for(; i + 4 <= length; i += 4, out += 3)
+		{
+			uint32_t a = BASE64_DECODE_TABLE[in[i]];
+			uint32_t b = BASE64_DECODE_TABLE[in[i + 1]];
+			uint32_t c = BASE64_DECODE_TABLE[in[i + 2]];
+			uint32_t d = BASE64_DECODE_TABLE[in[i + 3]];
+			if((a | b | c | d) & 0x80)
+				return false;
+			uint32_t value = (a << 18) | (b << 12) | (c << 6) | d;
+			out[0] = static_cast<uint8_t>(value >> 16);
+			out[1] = static_cast<uint8_t>(value >> 8);
+			out[2] = static_cast<uint8_t>(value);
 		}
 
-		return ret;
+		size_t tail = length - i;
+		if(tail == 1)
+			return false;
+		if(tail > 1)
+		{
+			uint32_t a = BASE64_DECODE_TABLE[in[i]];
+			uint32_t b = BASE64_DECODE_TABLE[in[i + 1]];
+			uint32_t c = tail == 3 ? BASE64_DECODE_TABLE[in[i + 2]] : 0;
+			if((a | b | c) & 0x80)
+				return false;
+			uint32_t value = (a << 18) | (b << 12) | (c << 6);
+			out[0] = static_cast<uint8_t>(value >> 16);
+			if(tail == 3)
+				out[1] = static_cast<uint8_t>(value >> 8);
+		}
+		return true;
 	}
 
-	unsigned int Base64Decompressor::pos_of_char(const unsigned char chr)
-	{
-		//
-		// Return the position of chr within base64_encode()
-		//
+	#ifdef TSON_BASE64_X86
+	// The vector decoders follow Wojciech Muła's and Daniel Lemire's "Faster Base64 Encoding and Decoding
+	// using AVX2 Instructions": classify each character by its nibbles with pshufb, add a per-range offset
+	// to get its 6-bit value, then pack four values into three bytes with multiply-adds. They stop at the
+	// first block holding padding, URL-safe or invalid characters, and leave the rest to decodeScalar().
+	// Every store writes a full register, so a block is only decoded while enough input is left to
+	// guarantee that the extra bytes still fall inside the output.
 
-		if      (chr >= 'A' && chr <= 'Z') return chr - 'A';
-		else if (chr >= 'a' && chr <= 'z') return chr - 'a' + ('Z' - 'A')               + 1;
-		else if (chr >= '0' && chr <= '9') return chr - '0' + ('Z' - 'A') + ('z' - 'a') + 2;
-		else if (chr == '+' || chr == '-') return 62; // Be liberal with input and accept both url ('-') and non-url ('+') base 64 characters (
-		else if (chr == '/' || chr == '_') return 63; // Ditto for '/' and '_'
+	/*!
+	 * @return The number of input characters decoded, a multiple of 16
+	 */
+	size_t Base64Decompressor::decodeSse41(std::string_view s, uint8_t *out)
+	{
+		const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		                                    0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+		const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		                                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m128i mask2f = _mm_set1_epi8(0x2f);
+		const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+		size_t i = 0;
+		for(; s.size() - i >= 24; i += 16, out += 12)
+		{
+			__m128i str = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s.data() + i));
+			__m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2f);
+			__m128i loNibbles = _mm_and_si128(str, mask2f);
+			__m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+			__m128i lo = _mm_shuffle_epi8(lutLo, loNibbles);
+			if(!_mm_test_all_zeros(lo, hi))
+				break;
+			__m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(str, mask2f), hiNibbles));
+			str = _mm_add_epi8(str, roll);
+			str = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+			str = _mm_madd_epi16(str, _mm_set1_epi32(0x00011000));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_shuffle_epi8(str, pack));
+		}
+		return i;
+	}
 
-		throw "If input is correct, this line should never be reached.";
+	/*!
+	 * @return The number of input characters decoded, a multiple of 32
+	 */
+	size_t Base64Decompressor::decodeAvx2(std::string_view s, uint8_t *out)
+	{
+		const __m256i lutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		                                       0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a,
+		                                       0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+		                                       0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+		const __m256i lutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		                                       0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+		                                       0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+		                                       0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0,
+		                                         0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const __m256i mask2f = _mm256_set1_epi8(0x2f);
+		const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+		                                      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+
+		size_t i = 0;
+		for(; s.size() - i >= 48; i += 32, out += 24)
+		{
+			__m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s.data() + i));
+			__m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2f);
+			__m256i loNibbles = _mm256_and_si256(str, mask2f);
+			__m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+			__m256i lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+			if(!_mm256_testz_si256(lo, hi))
+				break;
+			__m256i roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask2f), hiNibbles));
+			str = _mm256_add_epi8(str, roll);
+			str = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+			str = _mm256_madd_epi16(str, _mm256_set1_epi32(0x00011000));
+			str = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(str, pack), lanes);
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), str);
+		}
+		return i;
 	}
+	#endif
 
 	/*!
 	 * UNUSED! Does nothing
@@ -1418,6 +1720,222 @@ namespace tson
 /*** End of inlined file: Lzma.hpp ***/
 
 
+/*** Start of inlined file: Zlib.hpp ***/
+//
+// Decompressors for Tiled's "zlib", "gzip" and "zstd" layer compression. Define TSON_USE_ZLIB and/or TSON_USE_ZSTD
+// and link against the library to enable them. tson::Tileson registers the enabled ones by default.
+//
+
+#ifndef TILESON_ZLIB_HPP
+#define TILESON_ZLIB_HPP
+
+#ifdef TSON_USE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef TSON_USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <fstream>
+#include <iterator>
+
+namespace tson
+{
+	#ifdef TSON_USE_ZLIB
+	class ZlibDecompressor : public IDecompressor<std::string_view, std::string>, public IBufferDecompressor
+	{
+		public:
+			inline ZlibDecompressor() = default;
+
+			[[nodiscard]] inline const std::string &name() const override;
+
+			inline std::string decompress(const std::string_view &s) override;
+
+			inline std::string decompressFile(const fs::path &path) override;
+			inline std::string decompress(const void *data, size_t size) override;
+
+			inline bool decompressInto(const uint8_t *input, size_t inputSize, uint8_t *out, size_t outSize, size_t &written) override;
+
+		protected:
+			inline explicit ZlibDecompressor(int windowBits) : m_windowBits {windowBits} {}
+
+		private:
+			int m_windowBits {15}; /*! 15 reads a zlib header, 15 + 16 a gzip header */
+			inline static const std::string NAME = "zlib";
+	};
+
+	class GzipDecompressor : public ZlibDecompressor
+	{
+		public:
+			inline GzipDecompressor() : ZlibDecompressor(15 + 16) {}
+
+			[[nodiscard]] inline const std::string &name() const override { return NAME; }
+
+		private:
+			inline static const std::string NAME = "gzip";
+	};
+
+	const std::string &ZlibDecompressor::name() const
+	{
+		return NAME;
+	}
+
+	std::string ZlibDecompressor::decompress(const std::string_view &s)
+	{
+		return decompress(s.data(), s.size());
+	}
+
+	std::string ZlibDecompressor::decompressFile(const fs::path &path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		std::string data {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+		return decompress(data);
+	}
+
+	/*!
+	 * Grows the output as needed.
+	 * @return The decompressed data, or an empty string if the input is not valid
+	 */
+	std::string ZlibDecompressor::decompress(const void *data, size_t size)
+	{
+		z_stream stream {};
+		if(inflateInit2(&stream, m_windowBits) != Z_OK)
+			return std::string();
+
+		std::string out;
+		stream.next_in = static_cast<Bytef *>(const_cast<void *>(data));
+		stream.avail_in = static_cast<uInt>(size);
+		int status = Z_OK;
+		while(status == Z_OK)
+		{
+			size_t used = stream.total_out;
+			out.resize(used + std::max<size_t>(used, 16 * 1024));
+			stream.next_out = reinterpret_cast<Bytef *>(out.data() + used);
+			stream.avail_out = static_cast<uInt>(out.size() - used);
+			status = inflate(&stream, Z_NO_FLUSH);
+		}
+		out.resize(stream.total_out);
+		inflateEnd(&stream);
+		return status == Z_STREAM_END ? out : std::string();
+	}
+
+	bool ZlibDecompressor::decompressInto(const uint8_t *input, size_t inputSize, uint8_t *out, size_t outSize, size_t &written)
+	{
+		z_stream stream {};
+		if(inflateInit2(&stream, m_windowBits) != Z_OK)
+			return false;
+
+		stream.next_in = const_cast<Bytef *>(input);
+		stream.avail_in = static_cast<uInt>(inputSize);
+		stream.next_out = out;
+		stream.avail_out = static_cast<uInt>(outSize);
+		int status = inflate(&stream, Z_FINISH);
+		written = stream.total_out;
+		// Like zstd: the stream has to end, checksum included, exactly with the input. A stream that
+		// would inflate to more than fits stops short of its end.
+		bool valid = status == Z_STREAM_END && stream.avail_in == 0;
+		inflateEnd(&stream);
+		return valid;
+	}
+	#endif
+
+	#ifdef TSON_USE_ZSTD
+	class ZstdDecompressor : public IDecompressor<std::string_view, std::string>, public IBufferDecompressor
+	{
+		public:
+			[[nodiscard]] inline const std::string &name() const override;
+
+			inline std::string decompress(const std::string_view &s) override;
+
+			inline std::string decompressFile(const fs::path &path) override;
+			inline std::string decompress(const void *data, size_t size) override;
+
+			inline bool decompressInto(const uint8_t *input, size_t inputSize, uint8_t *out, size_t outSize, size_t &written) override;
+
+		private:
+			inline static const std::string NAME = "zstd";
+	};
+
+	const std::string &ZstdDecompressor::name() const
+	{
+		return NAME;
+	}
+
+	std::string ZstdDecompressor::decompress(const std::string_view &s)
+	{
+		return decompress(s.data(), s.size());
+	}
+
+	std::string ZstdDecompressor::decompressFile(const fs::path &path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		std::string data {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+		return decompress(data);
+	}
+
+	/*!
+	 * Grows the output as needed.
+	 * @return The decompressed data, or an empty string if the input is not valid
+	 */
+	std::string ZstdDecompressor::decompress(const void *data, size_t size)
+	{
+		ZSTD_DStream *stream = ZSTD_createDStream();
+		if(stream == nullptr)
+			return std::string();
+		ZSTD_initDStream(stream);
+
+		std::string out;
+		size_t used = 0;
+		ZSTD_inBuffer input {data, size, 0};
+		size_t status = 1;
+		bool valid = true;
+		while(valid && (status != 0 || input.pos < input.size))
+		{
+			out.resize(used + std::max(used, ZSTD_DStreamOutSize()));
+			ZSTD_outBuffer output {out.data() + used, out.size() - used, 0};
+			status = ZSTD_decompressStream(stream, &output, &input);
+			used += output.pos;
+			// Running out of input with room left means the frame was cut short
+			valid = !ZSTD_isError(status) && (status == 0 || input.pos < input.size || output.pos == output.size);
+		}
+		ZSTD_freeDStream(stream);
+		out.resize(used);
+		return valid ? out : std::string();
+	}
+
+	bool ZstdDecompressor::decompressInto(const uint8_t *input, size_t inputSize, uint8_t *out, size_t outSize, size_t &written)
+	{
+		ZSTD_DStream *stream = ZSTD_createDStream();
+		if(stream == nullptr)
+			return false;
+		ZSTD_initDStream(stream);
+
+		ZSTD_inBuffer in {input, inputSize, 0};
+		ZSTD_outBuffer output {out, outSize, 0};
+		size_t status = 1;
+		bool valid = true;
+		// Runs to the end of the frame even once the output is full, so its
+		// checksum, if it has one, gets checked
+		while(valid && status != 0)
+		{
+			const size_t progress = in.pos + output.pos;
+			status = ZSTD_decompressStream(stream, &output, &in);
+			// Stalling means the frame was cut short or does not fit
+			valid = !ZSTD_isError(status) && (status == 0 || in.pos + output.pos != progress);
+		}
+		ZSTD_freeDStream(stream);
+		written = output.pos;
+		// Anything after the frame would be more tiles than fit
+		return valid && in.pos == in.size;
+	}
+	#endif
+}
+
+#endif //TILESON_ZLIB_HPP
+
+/*** End of inlined file: Zlib.hpp ***/
+
+
 /*** Start of inlined file: DecompressorContainer.hpp ***/
 //
 // Created by robin on 30.07.2020.
@@ -1445,6 +1963,9 @@ namespace tson
 			inline void clear();
 
 			inline IDecompressor<std::string_view, std::string> *get(std::string_view name);
+
+			inline bool decodeTileData(std::string_view data, std::string_view encoding, std::string_view compression,
+			                           size_t count, std::vector<uint32_t> &ids);
 		private:
 			//Key: name,
 			std::vector<std::unique_ptr<IDecompressor<std::string_view, std::string>>> m_decompressors;
@@ -1520,6 +2041,60 @@ namespace tson
 	{
 		m_decompressors.clear();
 	}
+
+	/*!
+	 * Decodes base64 tile layer data straight into tile ids, decompressing on the way if compression is set.
+	 * Needs the Base64Decompressor and, if compressed, a decompressor that implements IBufferDecompressor.
+	 * @param count Number of ids the layer holds, its width times its height; 0 is rejected
+	 * @param ids The decoded tile ids, in native byte order
+	 * @return false if the data could not be decoded this way, or a compressed layer inflates to more than
+	 * count ids, which leaves ids empty
+	 */
+	bool DecompressorContainer::decodeTileData(std::string_view data, std::string_view encoding, std::string_view compression,
+	                                           size_t count, std::vector<uint32_t> &ids)
+	{
+		ids.clear();
+		// Without a size there is nothing to check the decoded data against
+		if(count == 0 || encoding != "base64" || dynamic_cast<Base64Decompressor *>(get(encoding)) == nullptr)
+			return false;
+
+		size_t size = Base64Decompressor::decodedSize(data);
+		if(compression.empty())
+		{
+			ids.resize((size + 3) / 4);
+			if(!Base64Decompressor::decode(data, reinterpret_cast<uint8_t *>(ids.data())))
+			{
+				ids.clear();
+				return false;
+			}
+			ids.resize(size / 4);
+		}
+		else
+		{
+			auto *decompressor = dynamic_cast<IBufferDecompressor *>(get(compression));
+			if(decompressor == nullptr)
+				return false;
+			std::vector<uint8_t> compressed(size);
+			ids.resize(count);
+			size_t written = 0;
+			if(!Base64Decompressor::decode(data, compressed.data()) ||
+			   !decompressor->decompressInto(compressed.data(), compressed.size(), reinterpret_cast<uint8_t *>(ids.data()),
+			                                 count * sizeof(uint32_t), written))
+			{
+				ids.clear();
+				return false;
+			}
+			ids.resize(written / 4);
+		}
+
+		// Tiled stores the ids in little-endian byte order
+		if constexpr(std::endian::native == std::endian::big)
+		{
+			for(uint32_t &id : ids)
+				id = ((id & 0xffu) << 24) | ((id & 0xff00u) << 8) | ((id >> 8) & 0xff00u) | (id >> 24);
+		}
+		return true;
+	}
 }
 #endif //TILESON_DECOMPRESSORCONTAINER_HPP
 
@@ -1842,6 +2417,12 @@ namespace tson
 			 */
 			[[nodiscard]] virtual std::vector<std::unique_ptr<IJson>> array() = 0;
 			[[nodiscard]] virtual std::vector<std::unique_ptr<IJson>> &array(std::string_view key) = 0;
+			/*!
+			 * Gets an array of unsigned integers, like tile layer data, in one go.
+			 * Backends can override this with a path that skips the IJson wrapper per element.
+			 * @return The values of the array
+			 */
+			[[nodiscard]] virtual std::vector<uint32_t> uint32Array(std::string_view key);
 			/*!
 			 * Get the size of an object. This will be equal to the number of
 			 * variables an object contains.
@@ -1940,6 +2521,15 @@ namespace tson
 			return nullptr;
 	}
 
+	inline std::vector<uint32_t> IJson::uint32Array(std::string_view key)
+	{
+		std::vector<std::unique_ptr<IJson>> &items = array(key);
+		std::vector<uint32_t> values;
+		values.reserve(items.size());
+		std::for_each(items.begin(), items.end(), [&](std::unique_ptr<IJson> &item) { values.push_back(item->get<uint32_t>()); });
+		return values;
+	}
+
 }
 
 #endif //TILESON_IJSON_HPP
@@ -2643,6 +3233,17 @@ namespace tson
 				return m_arrayListDataCache[key.data()];
 			}
 
+			inline std::vector<uint32_t> uint32Array(std::string_view key) override
+			{
+				if(isObject())
+				{
+					const json11::Json &v = m_json->operator[](key.data());
+					if(v.is_uint_array())
+						return v.uint_array_items();
+				}
+				return IJson::uint32Array(key);
+			}
+
 			[[nodiscard]] inline size_t size() const override
 			{
 				if(m_json->is_object())
@@ -3262,6 +3863,15 @@ namespace tson
 	static constexpr uint32_t FLIPPED_HORIZONTALLY_FLAG = 0x80000000;
 	static constexpr uint32_t FLIPPED_VERTICALLY_FLAG   = 0x40000000;
 	static constexpr uint32_t FLIPPED_DIAGONALLY_FLAG   = 0x20000000;
+
+	/*!
+	 * Slot of a tile id, flip flags included, in the tile table of tson::Map.
+	 * The gid picks a group of eight slots, the three flip flags pick one of them.
+	 */
+	inline constexpr size_t tileTableIndex(uint32_t id)
+	{
+		return (static_cast<size_t>(id & ~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG)) << 3) | (id >> 29);
+	}
 	/*!
 	 * Object.hpp - ObjectFlipFlags
 	 */
@@ -4131,7 +4741,7 @@ namespace tson
 			inline const tson::Rect &getDrawingRect() const; //Defined in tileson_forward.hpp
 
 		private:
-			tson::Tile *m_tile;
+			tson::Tile *m_tile {};
 			tson::Vector2i m_posInTileUnits;
 			tson::Vector2f m_position;
 
@@ -4252,17 +4862,17 @@ namespace tson
 			inline T get(const std::string &name);
 			inline tson::Property * getProp(const std::string &name);
 
-			inline void assignTileMap(std::map<uint32_t, tson::Tile*> *tileMap);
+			inline void assignTileTable(const std::vector<tson::Tile*> *tileTable);
 			inline void createTileData(const Vector2i &mapSize, bool isInfiniteMap);
 
-			[[nodiscard]] inline const std::map<std::tuple<int, int>, tson::Tile *> &getTileData() const;
+			[[nodiscard]] inline const std::vector<tson::Tile *> &getTileData() const;
 			inline tson::Tile * getTileData(int x, int y);
 
 			//v1.2.0-stuff
 			[[nodiscard]] inline const Colori &getTintColor() const;
 			[[nodiscard]] inline tson::Map *getMap() const;
 
-			[[nodiscard]] inline std::map<std::tuple<int, int>, tson::TileObject> &getTileObjects();
+			[[nodiscard]] inline std::vector<tson::TileObject> &getTileObjects();
 			inline tson::TileObject * getTileObject(int x, int y);
 			[[nodiscard]] inline const std::set<uint32_t> &getUniqueFlaggedTiles() const;
 			inline void resolveFlaggedTiles();
@@ -4298,17 +4908,21 @@ namespace tson
 			tson::Vector2f                                 m_parallax{1.f, 1.f};    /*! Tiled v1.5: parallax factor for this layer. Defaults to 1.
 																								  x = 'parallaxx', y = 'parallaxy'*/
 
-			std::map<uint32_t, tson::Tile*>                *m_tileMap;
-			std::map<std::tuple<int, int>, tson::Tile*>    m_tileData;                        /*! Key: Tuple of x and y pos in tile units. */
+			const std::vector<tson::Tile*>                 *m_tileTable {};                   /*! The tile table of the map, see tson::tileTableIndex() */
+			std::vector<tson::Tile*>                       m_tileData;                        /*! Row-major, one entry per cell. nullptr when empty. */
+			tson::Vector2i                                 m_tileDataSize;                    /*! Width and height of m_tileData in tile units */
 
 			//v1.2.0-stuff
 			tson::Colori                                        m_tintcolor;                  /*! 'tintcolor': Hex-formatted color (#RRGGBB or #AARRGGBB) that is multiplied with
 																							   *        any graphics drawn by this layer or any child layers (optional). */
 			inline void decompressData();                                                     /*! Defined in tileson_forward.hpp */
 			inline void queueFlaggedTile(size_t x, size_t y, uint32_t id);                    /*! Queue a flagged tile */
+			inline void createTileObjects();                                                  /*! Packs m_tileData into m_tileObjects */
+			[[nodiscard]] inline bool isInsideTileData(int x, int y) const;
 
 			tson::Map *                                         m_map;                        /*! The map who owns this layer */
-			std::map<std::tuple<int, int>, tson::TileObject>    m_tileObjects;
+			std::vector<tson::TileObject>                       m_tileObjects;                /*! Non-empty tiles only, in row-major order */
+			std::vector<uint32_t>                               m_tileObjectIndex;            /*! Row-major, index into m_tileObjects + 1. 0 when empty. */
 			std::set<uint32_t>                                  m_uniqueFlaggedTiles;
 			std::vector<tson::FlaggedTile>                      m_flaggedTiles;
 
@@ -4384,10 +4998,7 @@ bool tson::Layer::parse(IJson &json, tson::Map *map)
 	if(json.count("data") > 0)
 	{
 		if(json["data"].isArray())
-		{
-			auto &array = json.array("data");
-			std::for_each(array.begin(), array.end(), [&](std::unique_ptr<IJson> &item) { m_data.push_back(item->get<uint32_t>()); });
-		}
+			m_data = json.uint32Array("data");
 		else
 		{
 			m_base64Data = json["data"].get<std::string>();
@@ -4700,33 +5311,33 @@ tson::LayerType tson::Layer::getType() const
 }
 
 /*!
- * Assigns a tilemap of pointers to existing tiles.
- * @param tileMap The tilemap. key: tile id, value: pointer to Tile.
+ * Assigns the table of pointers to existing tiles.
+ * @param tileTable The tile table. index: tson::tileTableIndex(id), value: pointer to Tile or nullptr.
  */
-void tson::Layer::assignTileMap(std::map<uint32_t, tson::Tile *> *tileMap)
+void tson::Layer::assignTileTable(const std::vector<tson::Tile *> *tileTable)
 {
-	m_tileMap = tileMap;
+	m_tileTable = tileTable;
 }
 
 /*!
- * Get tile data as some kind of map with x and y position with pointers to existing tiles.
- * Map only contains tiles that are not empty. x and y position is in tile units.
+ * Get tile data as a dense, row-major grid of pointers to existing tiles.
+ * Empty cells are nullptr. The grid has the same size as the map.
  *
- * Example of getting tile from the returned map:
+ * Example of getting tile from the returned grid:
  *
- * Tile *tile = tileData[{0, 4}];
+ * Tile *tile = tileData[4 * map->getSize().x + 0];
  *
- * @return A map that represents the data returned from getData() in a 2D map with Tile pointers.
+ * @return A grid that represents the data returned from getData() with Tile pointers.
  */
-const std::map<std::tuple<int, int>, tson::Tile *> &tson::Layer::getTileData() const
+const std::vector<tson::Tile *> &tson::Layer::getTileData() const
 {
 	return m_tileData;
 }
 
 /*!
  * A safe way to get tile data
- * Get tile data as some kind of map with x and y position with pointers to existing tiles.
- * Map only contains tiles that are not empty. x and y position is in tile units.
+ * Looks up a pointer to an existing tile in constant time.
+ * x and y position is in tile units.
  *
  * Example of getting tile:
  * Tile *tile = layer->getTileData(0, 4)
@@ -4737,7 +5348,7 @@ const std::map<std::tuple<int, int>, tson::Tile *> &tson::Layer::getTileData() c
  */
 tson::Tile *tson::Layer::getTileData(int x, int y)
 {
-	return (m_tileData.count({x, y}) > 0) ? m_tileData[{x,y}] : nullptr;
+	return isInsideTileData(x, y) ? m_tileData[static_cast<size_t>(y) * m_tileDataSize.x + x] : nullptr;
 }
 
 /*!
@@ -4762,6 +5373,8 @@ void tson::Layer::createTileData(const Vector2i &mapSize, bool isInfiniteMap)
 	size_t y = 0;
 	if(!isInfiniteMap)
 	{
+		m_tileDataSize = mapSize;
+		m_tileData.assign(static_cast<size_t>(mapSize.x) * mapSize.y, nullptr);
 		std::for_each(m_data.begin(), m_data.end(), [&](uint32_t tileId)
 		{
 			if (x == mapSize.x)
@@ -4770,14 +5383,17 @@ void tson::Layer::createTileData(const Vector2i &mapSize, bool isInfiniteMap)
 				x = 0;
 			}
 
-			if (tileId > 0 && m_tileMap->count(tileId) > 0)
-			{
-				m_tileData[{static_cast<int>(x), static_cast<int>(y)}] = m_tileMap->at(tileId);
-				m_tileObjects[{static_cast<int>(x), static_cast<int>(y)}] = {{static_cast<int>(x), static_cast<int>(y)}, m_tileData[{static_cast<int>(x), static_cast<int>(y)}]};
-			}
-			else if(tileId > 0 && m_tileMap->count(tileId) == 0) //Tile with flip flags!
+			if (y >= static_cast<size_t>(mapSize.y))
+				return;
+
+			if(tileId > 0)
 			{
-				queueFlaggedTile(x, y, tileId);
+				size_t index = tileTableIndex(tileId);
+				tson::Tile *tile = (index < m_tileTable->size()) ? (*m_tileTable)[index] : nullptr;
+				if(tile != nullptr)
+					m_tileData[y * mapSize.x + x] = tile;
+				else //Tile with flip flags!
+					queueFlaggedTile(x, y, tileId);
 			}
 			x++;
 		});
@@ -4785,14 +5401,52 @@ void tson::Layer::createTileData(const Vector2i &mapSize, bool isInfiniteMap)
 	}
 }
 
-std::map<std::tuple<int, int>, tson::TileObject> &tson::Layer::getTileObjects()
+/*!
+ * Builds the packed list of tile objects from the dense tile data, in row-major order.
+ */
+void tson::Layer::createTileObjects()
+{
+	m_tileObjects.clear();
+	m_tileObjectIndex.assign(m_tileData.size(), 0);
+	for(size_t i = 0; i < m_tileData.size(); ++i)
+	{
+		if(m_tileData[i] == nullptr)
+			continue;
+
+		int x = static_cast<int>(i % m_tileDataSize.x);
+		int y = static_cast<int>(i / m_tileDataSize.x);
+		m_tileObjects.emplace_back(std::tuple<int, int>{x, y}, m_tileData[i]);
+		m_tileObjectIndex[i] = static_cast<uint32_t>(m_tileObjects.size());
+	}
+}
+
+bool tson::Layer::isInsideTileData(int x, int y) const
+{
+	return x >= 0 && y >= 0 && x < m_tileDataSize.x && y < m_tileDataSize.y;
+}
+
+/*!
+ * All non-empty tiles of the layer, in row-major order.
+ * @return
+ */
+std::vector<tson::TileObject> &tson::Layer::getTileObjects()
 {
 	return m_tileObjects;
 }
 
+/*!
+ * Looks up the tile object at a position in constant time.
+ * @param x X position in tile units
+ * @param y Y position in tile units
+ * @return pointer to tile object, if it exists. nullptr otherwise.
+ */
 tson::TileObject *tson::Layer::getTileObject(int x, int y)
 {
-	return (m_tileObjects.count({x, y}) > 0) ? &m_tileObjects[{x,y}] : nullptr;
+	if(!isInsideTileData(x, y))
+		return nullptr;
+
+	uint32_t index = m_tileObjectIndex[static_cast<size_t>(y) * m_tileDataSize.x + x];
+	return (index > 0) ? &m_tileObjects[index - 1] : nullptr;
 }
 
 const std::set<uint32_t> &tson::Layer::getUniqueFlaggedTiles() const
@@ -4804,12 +5458,11 @@ void tson::Layer::resolveFlaggedTiles()
 {
 	std::for_each(m_flaggedTiles.begin(), m_flaggedTiles.end(), [&](const tson::FlaggedTile &tile)
 	{
-		if (tile.id > 0 && m_tileMap->count(tile.id) > 0)
-		{
-			m_tileData[{static_cast<int>(tile.x), static_cast<int>(tile.y)}] = m_tileMap->at(tile.id);
-			m_tileObjects[{static_cast<int>(tile.x), static_cast<int>(tile.y)}] = {{static_cast<int>(tile.x), static_cast<int>(tile.y)}, m_tileData[{static_cast<int>(tile.x), static_cast<int>(tile.y)}]};
-		}
+		size_t index = tileTableIndex(tile.id);
+		if (tile.id > 0 && index < m_tileTable->size() && (*m_tileTable)[index] != nullptr)
+			m_tileData[tile.y * m_tileDataSize.x + tile.x] = (*m_tileTable)[index];
 	});
+	createTileObjects();
 }
 
 /*!
@@ -5776,6 +6429,7 @@ bool tson::Tile::parse(IJson &json, tson::Tileset *tileset, tson::Map *map)
 	bool allFound = parseId(json);
 
 	if(json.count("type") > 0) m_type = json["type"].get<std::string>(); //Optional
+	else if(json.count("class") > 0) m_type = json["class"].get<std::string>(); //Tiled 1.9 called it class
 	if(json.count("objectgroup") > 0) m_objectgroup = tson::Layer(json["objectgroup"], m_map); //Optional
 
 	if(json.count("imagewidth") > 0 && json.count("imageheight") > 0)
@@ -6566,13 +7220,18 @@ tson::Property *tson::Tileset::getProp(const std::string &name)
  */
 void tson::Tileset::generateMissingTiles()
 {
-	std::vector<uint32_t> tileIds;
+	//Compares gids: parsed tiles only have id == gid in a tileset starting at firstgid 1
+	std::vector<uint32_t> tileGids;
 	for(auto &tile : m_tiles)
-		tileIds.push_back(tile.getId());
+		tileGids.push_back(tile.getGid());
+
+	//A negative count would wrap around to billions of tiles
+	if(m_tileCount < 0 || (uint64_t) m_firstgid + (uint64_t) m_tileCount > UINT32_MAX)
+		return;
 
 	for(uint32_t i = m_firstgid; i < m_firstgid + (uint32_t) m_tileCount; ++i)
 	{
-		if(std::count(tileIds.begin(), tileIds.end(), i) == 0)
+		if(std::count(tileGids.begin(), tileGids.end(), i) == 0)
 		{
 			m_tiles.emplace_back(Tile(i, this, m_map));
 		}
@@ -6690,9 +7349,10 @@ namespace tson
 
 			[[nodiscard]] inline ParseStatus getStatus() const;
 			[[nodiscard]] inline const std::string &getStatusMessage() const;
-			[[nodiscard]] inline const std::map<uint32_t, tson::Tile *> &getTileMap() const;
+			[[nodiscard]] inline const std::vector<tson::Tile *> &getTileTable() const;
 
 			inline Layer * getLayer(const std::string &name);
+			inline Tile * getTile(uint32_t id);
 			inline Tileset * getTileset(const std::string &name);
 
 			template <typename T>
@@ -6729,14 +7389,14 @@ namespace tson
 			ParseStatus                            m_status {ParseStatus::OK};
 			std::string                            m_statusMessage {"OK"};
 
-			std::map<uint32_t, tson::Tile*>        m_tileMap;           /*! key: Tile ID. Value: Pointer to Tile*/
+			std::vector<tson::Tile*>               m_tileTable;         /*! index: tileTableIndex(Tile ID). Value: Pointer to Tile, nullptr if unused */
 
 			//v1.2.0
 			int                                    m_compressionLevel {-1};  /*! 'compressionlevel': The compression level to use for tile layer
 																			  *     data (defaults to -1, which means to use the algorithm default)
 																			  *     Introduced in Tiled 1.3*/
 			tson::DecompressorContainer *          m_decompressors;
-			std::map<uint32_t, tson::Tile>         m_flaggedTileMap;    /*! key: Tile ID. Value: Tile*/
+			std::map<uint32_t, tson::Tile>         m_flaggedTileMap;    /*! key: Tile ID. Value: Tile. Storage for the flagged entries of m_tileTable*/
 	};
 
 	/*!
@@ -6865,26 +7525,42 @@ bool tson::Map::createTilesetData(IJson &json)
  */
 void tson::Map::processData()
 {
-	m_tileMap.clear();
+	//Tilesets with negative counts, or gids running into the flip flags, get no entries
+	uint64_t const gidLimit = (uint64_t) (~(FLIPPED_HORIZONTALLY_FLAG | FLIPPED_VERTICALLY_FLAG | FLIPPED_DIAGONALLY_FLAG)) + 1;
+	uint64_t gidCount = 1;
+	for(auto &tileset : m_tilesets)
+	{
+		uint64_t const end = (uint64_t) tileset.getFirstgid() + (uint64_t) tileset.getTileCount();
+		if(tileset.getFirstgid() >= 1 && tileset.getTileCount() >= 0 && end <= gidLimit)
+			gidCount = std::max(gidCount, end);
+	}
+
+	m_tileTable.assign(static_cast<size_t>(gidCount) << 3, nullptr);
 	for(auto &tileset : m_tilesets)
 	{
-		std::for_each(tileset.getTiles().begin(), tileset.getTiles().end(), [&](tson::Tile &tile) { m_tileMap[tile.getGid()] = &tile; });
+		std::for_each(tileset.getTiles().begin(), tileset.getTiles().end(), [&](tson::Tile &tile)
+		{
+			size_t index = tileTableIndex(tile.getGid());
+			if(index < m_tileTable.size())
+				m_tileTable[index] = &tile;
+		});
 	}
 	std::for_each(m_layers.begin(), m_layers.end(), [&](tson::Layer &layer)
 	{
-		layer.assignTileMap(&m_tileMap);
+		layer.assignTileTable(&m_tileTable);
 		layer.createTileData(m_size, m_isInfinite);
 		const std::set<uint32_t> &flaggedTiles = layer.getUniqueFlaggedTiles();
 		for(uint32_t ftile : flaggedTiles)
 		{
 			tson::Tile tile {ftile, layer.getMap()};
-			if(m_tileMap.count(tile.getGid()))
+			size_t originalIndex = tileTableIndex(tile.getGid());
+			tson::Tile *originalTile = (originalIndex < m_tileTable.size()) ? m_tileTable[originalIndex] : nullptr;
+			if(originalTile != nullptr)
 			{
-				tson::Tile *originalTile = m_tileMap[tile.getGid()];
 				tile.addTilesetAndPerformCalculations(originalTile->getTileset());
 				tile.setProperties(originalTile->getProperties());
 				m_flaggedTileMap[ftile] = tile;
-				m_tileMap[ftile] = &m_flaggedTileMap[ftile];
+				m_tileTable[tileTableIndex(ftile)] = &m_flaggedTileMap[ftile];
 			}
 		}
 		layer.resolveFlaggedTiles();
@@ -7112,12 +7788,24 @@ const std::string &tson::Map::getStatusMessage() const
 }
 
 /*!
- * Get a tile map with pointers to every existing tile.
+ * Get the table with pointers to every existing tile, indexed by tson::tileTableIndex().
  * @return
  */
-const std::map<uint32_t, tson::Tile *> &tson::Map::getTileMap() const
+const std::vector<tson::Tile *> &tson::Map::getTileTable() const
 {
-	return m_tileMap;
+	return m_tileTable;
+}
+
+/*!
+ * Looks up a tile by its id in constant time. Ids with flip flags return the flipped variant,
+ * if the map uses it anywhere.
+ * @param id Tile ID, including flip flags
+ * @return pointer to the tile, if it exists. nullptr otherwise.
+ */
+tson::Tile *tson::Map::getTile(uint32_t id)
+{
+	size_t index = tileTableIndex(id);
+	return (index < m_tileTable.size()) ? m_tileTable[index] : nullptr;
 }
 
 tson::DecompressorContainer *tson::Map::getDecompressors()
@@ -7618,13 +8306,24 @@ namespace tson
 
 /*!
  *
- * @param includeBase64Decoder Includes the base64-decoder from "Base64Decompressor.hpp" if true.
+ * @param includeBase64Decoder Includes the base64-decoder from "Base64Decompressor.hpp" if true, along with the zlib, gzip
+ * and zstd decompressors that are enabled (see "Zlib.hpp").
  * Otherwise no other decompressors/decoders than whatever the user itself have added will be used.
  */
 tson::Tileson::Tileson(std::unique_ptr<tson::IJson> jsonParser, bool includeBase64Decoder) : m_json {std::move(jsonParser)}
 {
 	if(includeBase64Decoder)
+	{
 		m_decompressors.add<Base64Decompressor>();
+		// Tiled only compresses base64 data
+		#ifdef TSON_USE_ZLIB
+		m_decompressors.add<ZlibDecompressor>();
+		m_decompressors.add<GzipDecompressor>();
+		#endif
+		#ifdef TSON_USE_ZSTD
+		m_decompressors.add<ZstdDecompressor>();
+		#endif
+	}
 }
 
 /*!
@@ -7840,6 +8539,11 @@ void tson::Layer::decompressData()
 	if(m_encoding.empty() && m_compression.empty())
 		return;
 
+	// Straight into the tile ids when the decompressors allow it, without the intermediate strings
+	size_t count = static_cast<size_t>(std::max(m_size.x, 0)) * static_cast<size_t>(std::max(m_size.y, 0));
+	if(container->decodeTileData(m_base64Data, m_encoding, m_compression, count, m_data))
+		return;
+
 	std::string data = m_base64Data;
 	bool hasBeenDecoded = false;
 	if(!m_encoding.empty() && container->contains(m_encoding))